@@ -10,14 +10,20 @@ local utils = require("modules/utils")
 ---@class IRF
 ---@field version string
 ---@field rawPools table<VariantPool>
----@field rawPoolPathLookup table<string, string>
 ---@field sortedRawPoolKeys table<string>
+---@field filteredPoolKeys table<string>
+---@field searchInput string
+---@field searchQuery string
+---@field memoryReport string
 ---@field OverlayOpen boolean
 IRF = {
     version = "1.1.0",
     rawPools = {},
-    rawPoolPathLookup = {},
     sortedRawPoolKeys = {},
+    filteredPoolKeys = {},
+    searchInput = "",
+    searchQuery = "",
+    memoryReport = "",
 
     OverlayOpen = false
 }
@@ -27,6 +33,10 @@ registerForEvent("onInit", function()
 end)
 
 registerForEvent("onOverlayOpen", function()
+    -- the catalog is empty if the native side had not loaded yet when the mod initialized
+    if #IRF.sortedRawPoolKeys == 0 then
+        stateManager.load()
+    end
     IRF.OverlayOpen = true
 end)
 
@@ -1,16 +1,34 @@
 local stateManager = require("modules/stateManager")
 local logger = require("modules/logger")
-local jsonUtils = require("modules/jsonUtils")
+local poolFilter = require("modules/poolFilter")
 
 local gui = {}
 
+-- reused every frame, only the visible rows of the pool table are drawn
+local clipper = nil
+
 function gui.draw() 
     if ImGui.Begin("Infinite Randomizer Framework") then
         if ImGui.Button("Reload From Disk") then
-            stateManager.load()
+            stateManager.reload()
+            IRF.memoryReport = ""
+        end
+        ImGui.Separator()
+
+        if ImGui.CollapsingHeader("Memory Usage") then
+            if ImGui.Button("Refresh") or IRF.memoryReport == "" then
+                IRF.memoryReport = InfiniteRandomizerFrameworkNative.GetMemoryReport()
+            end
+            ImGui.TextWrapped(IRF.memoryReport)
         end
         ImGui.Separator()
 
+        local searchInput, searchChanged = ImGui.InputTextWithHint("##Search", "Search pools and categories", IRF.searchInput, 256)
+        if searchChanged then
+            IRF.searchInput = searchInput
+            poolFilter.setQuery(searchInput)
+        end
+
         if (ImGui.BeginTable("Variant Pools", 4,  ImGuiTableFlags.SizingFixedFit)) then
             ImGui.TableSetupColumn("Enabled")
             ImGui.TableSetupColumn("Pool Name")
@@ -18,23 +36,29 @@ function gui.draw()
             ImGui.TableSetupColumn("Variants")
             ImGui.TableHeadersRow()
 
-            for _, k in ipairs(IRF.sortedRawPoolKeys) do
-                local poolObj = IRF.rawPools[k]
-                ImGui.TableNextRow()
-                ImGui.TableSetColumnIndex(0)
-                poolObj.enabled, changed = ImGui.Checkbox("##" .. tostring(poolObj.name), poolObj.enabled)
-                if changed then
-                    stateManager.saveRawPool(poolObj.name)
-                    InfiniteRandomizerFrameworkNative.LoadFromDisk()
-                end
+            clipper = clipper or ImGuiListClipper.new()
+            local keys = IRF.filteredPoolKeys
+            clipper:Begin(#keys, -1)
+            while clipper:Step() do
+                for i = clipper.DisplayStart + 1, clipper.DisplayEnd do
+                    local poolObj = IRF.rawPools[keys[i]]
+                    ImGui.TableNextRow()
+                    ImGui.TableSetColumnIndex(0)
+                    local enabled, changed = ImGui.Checkbox(poolObj.checkboxLabel, poolObj.enabled)
+                    if changed and stateManager.setPoolEnabled(poolObj.name, enabled) then
+                        poolObj.enabled = enabled
+                        IRF.memoryReport = ""
+                    end
 
-                ImGui.TableSetColumnIndex(1)
-                ImGui.Text(poolObj.name)
-                ImGui.TableSetColumnIndex(2)
-                ImGui.Text(poolObj.category)
-                ImGui.TableSetColumnIndex(3)
-                ImGui.Text(tostring(#poolObj.variants))
+                    ImGui.TableSetColumnIndex(1)
+                    ImGui.Text(poolObj.name)
+                    ImGui.TableSetColumnIndex(2)
+                    ImGui.Text(poolObj.category)
+                    ImGui.TableSetColumnIndex(3)
+                    ImGui.Text(poolObj.variantCountText)
+                end
             end
+            clipper:End()
 
             ImGui.EndTable()
         end
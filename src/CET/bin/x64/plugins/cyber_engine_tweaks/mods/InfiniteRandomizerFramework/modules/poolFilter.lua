@@ -0,0 +1,38 @@
+local poolFilter = {}
+
+local function filterKeys(keys, query)
+    if query == "" then
+        return keys
+    end
+
+    local filtered = {}
+    for _, k in ipairs(keys) do
+        if IRF.rawPools[k].searchText:find(query, 1, true) then
+            filtered[#filtered + 1] = k
+        end
+    end
+    return filtered
+end
+
+-- applies the current query to the whole catalog, called whenever the catalog was loaded again
+function poolFilter.refresh()
+    IRF.filteredPoolKeys = filterKeys(IRF.sortedRawPoolKeys, IRF.searchQuery)
+end
+
+-- a query containing the previous one can only match a subset of its results, so typing only searches those again
+function poolFilter.setQuery(text)
+    local query = text:lower()
+    if query == IRF.searchQuery then
+        return
+    end
+
+    local keys = IRF.sortedRawPoolKeys
+    if query:find(IRF.searchQuery, 1, true) then
+        keys = IRF.filteredPoolKeys
+    end
+
+    IRF.searchQuery = query
+    IRF.filteredPoolKeys = filterKeys(keys, query)
+end
+
+return poolFilter
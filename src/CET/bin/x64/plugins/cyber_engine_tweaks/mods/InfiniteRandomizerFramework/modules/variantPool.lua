@@ -1,23 +1,31 @@
-
 ---@class VariantPool
 ---@field name string
----@field variants table<IRFVariant>
+---@field variantCount number
 ---@field enabled boolean
 ---@field category string
+---@field filePath string
+---@field checkboxLabel string
+---@field variantCountText string
+---@field searchText string
 local variantPool = {}
 
-function variantPool:new(name, variants, enabled, category, resourceType)
+function variantPool:new(name, variantCount, enabled, category, filePath)
     local obj = {}
 
     obj.name = name
-    obj.variants = variants or {}
+    obj.variantCount = variantCount or 0
     obj.enabled = (enabled == nil) and true or enabled
     obj.category = category
-    obj.resourceType = resourceType or ""
+    obj.filePath = filePath
+
+    -- built once so drawing a row does not create strings every frame
+    obj.checkboxLabel = "##" .. tostring(name)
+    obj.variantCountText = tostring(obj.variantCount)
+    obj.searchText = (tostring(name) .. "\n" .. tostring(category)):lower()
 
     setmetatable(obj, self)
     self.__index = self
     return obj
 end
 
-return variantPool
\ No newline at end of file
+return variantPool
@@ -0,0 +1,59 @@
+#include "ConsoleLogger.h"
+
+#include <atomic>
+#include <iostream>
+#include <string>
+
+#include "RedLogger.h"
+
+namespace InfiniteRandomizerFramework {
+    namespace {
+        std::atomic<bool> g_verbose = true;
+        std::atomic<size_t> g_errorCount = 0;
+        std::atomic<size_t> g_warningCount = 0;
+        std::string g_context;
+
+        void Report(const char* level, const std::string& message) {
+            std::cerr << level << ": ";
+            if (!g_context.empty()) {
+                std::cerr << g_context << ": ";
+            }
+            std::cerr << message << '\n';
+        }
+    }
+
+    void ConsoleLogger::SetVerbose(const bool verbose) {
+        g_verbose = verbose;
+    }
+
+    void ConsoleLogger::SetContext(const std::string& context) {
+        g_context = context;
+    }
+
+    size_t ConsoleLogger::ErrorCount() {
+        return g_errorCount;
+    }
+
+    size_t ConsoleLogger::WarningCount() {
+        return g_warningCount;
+    }
+
+    void RedLogger::Info(const std::string& message) {
+        if (g_verbose) {
+            std::cout << message << '\n';
+        }
+    }
+
+    void RedLogger::Error(const std::string& message) {
+        g_errorCount++;
+        Report("error", message);
+    }
+
+    void RedLogger::Warning(const std::string& message) {
+        g_warningCount++;
+        Report("warning", message);
+    }
+
+    void RedLogger::Debug([[maybe_unused]] const std::string& message) {
+    }
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace InfiniteRandomizerFramework {
+    // RedLogger writes to the console in the compiler, these count what was reported
+    struct ConsoleLogger {
+        static void SetVerbose(bool verbose);
+        // file that following errors and warnings are attributed to, empty once the files are merged
+        static void SetContext(const std::string& context);
+        static size_t ErrorCount();
+        static size_t WarningCount();
+    };
+}
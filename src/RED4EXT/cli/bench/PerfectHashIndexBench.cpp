@@ -0,0 +1,105 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+#include "PerfectHashIndex.h"
+
+using namespace InfiniteRandomizerFramework;
+
+namespace {
+    // probes per measured pass, large enough that the smallest index is looked up many times over
+    constexpr size_t g_probeCount = 1 << 22;
+    constexpr size_t g_probeGroupSize = 16;
+
+    uint64_t SplitMix(uint64_t& state) {
+        uint64_t value = (state += 0x9e3779b97f4a7c15ULL);
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+    template<typename Lookup>
+    double NanosecondsPerProbe(const std::vector<uint64_t>& probes, Lookup lookup, uint64_t& found) {
+        const auto start = std::chrono::steady_clock::now();
+        found += lookup(probes);
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / static_cast<double>(probes.size());
+    }
+
+    void Run(const size_t keyCount) {
+        uint64_t state = keyCount;
+        std::vector<uint64_t> keys(keyCount);
+        for (auto& key : keys) {
+            key = SplitMix(state);
+        }
+
+        // half the probes hit, like sectors where only some nodes reference replaceable resources
+        std::vector<uint64_t> probes(g_probeCount);
+        for (size_t i = 0; i < probes.size(); i++) {
+            probes[i] = i % 2 == 0 ? keys[SplitMix(state) % keyCount] : SplitMix(state);
+        }
+
+        const auto buildStart = std::chrono::steady_clock::now();
+        PerfectHashIndex index;
+        if (!index.Build(keys)) {
+            std::printf("%zu keys: build failed\n", keyCount);
+            return;
+        }
+        const std::chrono::duration<double, std::milli> buildTime = std::chrono::steady_clock::now() - buildStart;
+
+        std::unordered_map<uint64_t, uint32_t> map;
+        map.reserve(keyCount);
+        for (uint32_t i = 0; i < keyCount; i++) {
+            map.emplace(keys[i], i);
+        }
+
+        uint64_t found = 0;
+        const auto mapTime = NanosecondsPerProbe(probes, [&map](const std::vector<uint64_t>& batch) {
+            uint64_t hits = 0;
+            for (const auto key : batch) {
+                hits += map.find(key) != map.end();
+            }
+            return hits;
+        }, found);
+
+        const auto findTime = NanosecondsPerProbe(probes, [&index](const std::vector<uint64_t>& batch) {
+            uint64_t hits = 0;
+            for (const auto key : batch) {
+                hits += index.Find(key) != PerfectHashIndex::npos;
+            }
+            return hits;
+        }, found);
+
+        // the staged lookup sector patching uses, see ProbeCandidates
+        const auto groupedTime = NanosecondsPerProbe(probes, [&index](const std::vector<uint64_t>& batch) {
+            uint64_t hits = 0;
+            uint32_t slots[g_probeGroupSize];
+            for (size_t groupStart = 0; groupStart < batch.size(); groupStart += g_probeGroupSize) {
+                for (size_t i = 0; i < g_probeGroupSize; i++) {
+                    index.PrefetchBucket(batch[groupStart + i]);
+                }
+                for (size_t i = 0; i < g_probeGroupSize; i++) {
+                    slots[i] = index.Locate(batch[groupStart + i]);
+                    index.PrefetchSlot(slots[i]);
+                }
+                for (size_t i = 0; i < g_probeGroupSize; i++) {
+                    hits += index.Verify(slots[i], batch[groupStart + i]);
+                }
+            }
+            return hits;
+        }, found);
+
+        const auto indexBits = static_cast<double>(index.MemoryUsage() - keyCount * sizeof(uint64_t)) * 8.0 / static_cast<double>(keyCount);
+        std::printf("%8zu keys: build %8.1f ms, %.2f bits per key besides the keys | ns per lookup: unordered_map %6.1f, Find %6.1f, grouped %6.1f (%llu hits)\n",
+                    keyCount, buildTime.count(), indexBits, mapTime, findTime, groupedTime, static_cast<unsigned long long>(found));
+    }
+}
+
+int main() {
+    for (const size_t keyCount : {1000, 100000, 1000000}) {
+        Run(keyCount);
+    }
+    return 0;
+}
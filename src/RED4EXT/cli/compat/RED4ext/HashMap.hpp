@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+// the sdk hash map pulls in the game allocators which only build on windows
+// CName and ResourcePath only need the primary template to specialize
+namespace RED4ext
+{
+template<typename T, typename enabled = void>
+struct HashMapHash
+{
+};
+} // namespace RED4ext
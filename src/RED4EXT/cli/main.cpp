@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ConsoleLogger.h"
+#include "DataMerge.h"
+#include "DataParser.h"
+#include "FileIndex.h"
+#include "PoolBundle.h"
+#include "RedLogger.h"
+
+namespace fs = std::filesystem;
+using namespace InfiniteRandomizerFramework;
+
+namespace {
+    constexpr int g_exitDataErrors = 1;
+    constexpr int g_exitUsage = 2;
+
+    void PrintUsage() {
+        std::cerr << "usage: irfc <data directory> [--bundle <output file>] [--index <output file>] [--quiet]\n"
+                     "  reads <data directory>/categories and <data directory>/variantPools like the plugin does,\n"
+                     "  reports malformed files and entries, prints merge statistics and optionally compiles\n"
+                     "  the accepted categories and pools into a bundle for <game>/.../data/bundles.\n"
+                     "  --index lists both directories for the plugin's useFileIndex, write it to <game>/.../cache/fileIndex.bin\n"
+                     "  through the same virtual file system the game runs in\n";
+    }
+
+    // json files of the directory in name order, so reports are stable across runs and machines
+    std::vector<fs::path> ListJsonFiles(const fs::path& directory) {
+        std::vector<fs::path> files;
+        std::error_code error;
+        for (const auto& file : fs::directory_iterator(directory, error)) {
+            if (file.path().extension() == ".json" && file.is_regular_file()) {
+                files.push_back(file.path());
+            }
+        }
+        if (error) {
+            RedLogger::Error(std::format("Failed to list {}: {}", directory.string(), error.message()));
+        }
+        std::ranges::sort(files);
+        return files;
+    }
+
+    template<typename T, typename Parse>
+    std::unordered_map<std::string, T> ParseDirectory(const fs::path& directory, const char* kind, Parse parse) {
+        std::unordered_map<std::string, T> parsed;
+        // the file each name was first loaded from, for reporting a collision
+        std::unordered_map<std::string, std::string> sources;
+        for (const auto& path : ListJsonFiles(directory)) {
+            const auto displayPath = path.filename().string();
+            ConsoleLogger::SetContext(displayPath);
+
+            std::ifstream fileStream(path, std::ios::binary);
+            if (!fileStream) {
+                RedLogger::Error(std::format("Failed to open {}.", displayPath));
+                continue;
+            }
+            std::stringstream buffer;
+            buffer << fileStream.rdbuf();
+
+            std::string name;
+            T value{};
+            if (!parse(displayPath, buffer.str(), name, value)) {
+                continue;
+            }
+
+            if (!parsed.try_emplace(name, std::move(value)).second) {
+                RedLogger::Error(std::format("Failed to load {} {}: {} with conflicting name exists in {}.", kind, name, kind,
+                                             sources.at(name)));
+                continue;
+            }
+            sources.emplace(std::move(name), displayPath);
+        }
+        ConsoleLogger::SetContext({});
+        return parsed;
+    }
+
+    // the same index the plugin keeps with useFileIndex, so a data directory served through a mod manager's virtual file
+    // system can be listed once from outside the game
+    bool WriteFileIndex(const fs::path& dataDir, const fs::path& indexPath) {
+        FileIndex index;
+        for (const auto& directory : {dataDir / "categories", dataDir / "variantPools"}) {
+            std::error_code error;
+            const auto writeTime = fs::last_write_time(directory, error);
+            if (error) {
+                continue;
+            }
+
+            std::vector<std::string> names;
+            for (const auto& path : ListJsonFiles(directory)) {
+                names.push_back(path.filename().string());
+            }
+            index.Store(directory, static_cast<int64_t>(writeTime.time_since_epoch().count()), std::move(names));
+        }
+        return index.Save(indexPath);
+    }
+
+    void PrintStatistics(const std::unordered_map<std::string, Category>& categories, const ResolvedPools& resolved) {
+        // mirrors the plugin merge, every (resource, appearance) pair of a category that received variants
+        // is replaceable and pairs with equal category sets share one distribution
+        std::map<std::pair<uint64_t, uint64_t>, std::vector<uint32_t>> membership;
+        std::map<std::string, size_t> entriesByType;
+        size_t variantEntries = 0;
+        for (uint32_t catId = 0; catId < resolved.categoryById.size(); catId++) {
+            if (resolved.categoryEntries[catId].empty()) {
+                continue;
+            }
+
+            const auto* category = resolved.categoryById[catId];
+            variantEntries += resolved.categoryEntries[catId].size();
+            entriesByType[category->extension] += resolved.categoryEntries[catId].size();
+            for (const auto& entry : category->entries) {
+                auto& ids = membership[{entry.resourcePath.hash, entry.appearance.hash}];
+                if (ids.empty() || ids.back() != catId) {
+                    ids.push_back(catId);
+                }
+            }
+        }
+
+        std::unordered_set<uint64_t> resources;
+        std::set<std::vector<uint32_t>> distinctSets;
+        for (const auto& [pair, ids] : membership) {
+            resources.insert(pair.first);
+            distinctSets.insert(ids);
+        }
+
+        std::cout << std::format("categories: {}\n", categories.size());
+        std::cout << std::format("variant pools: {} accepted, {} rejected, {} disabled\n", resolved.loadedPools.size(),
+                                 resolved.rejectedPools, resolved.disabledPools);
+        std::cout << std::format("variant entries: {}\n", variantEntries);
+        for (const auto& [extension, count] : entriesByType) {
+            std::cout << std::format("  {}: {}\n", extension, count);
+        }
+        std::cout << std::format("replaceable resources: {}\n", resources.size());
+        std::cout << std::format("resource and appearance pairs: {}\n", membership.size());
+        std::cout << std::format("distinct replacement sets: {}\n", distinctSets.size());
+    }
+}
+
+int main(int argc, char** argv) {
+    fs::path dataDir;
+    fs::path bundlePath;
+    fs::path indexPath;
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        if (argument == "--bundle" && i + 1 < argc) {
+            bundlePath = argv[++i];
+        }
+        else if (argument == "--index" && i + 1 < argc) {
+            indexPath = argv[++i];
+        }
+        else if (argument == "--quiet") {
+            ConsoleLogger::SetVerbose(false);
+        }
+        else if (dataDir.empty() && !argument.starts_with("--")) {
+            dataDir = argument;
+        }
+        else {
+            PrintUsage();
+            return g_exitUsage;
+        }
+    }
+
+    std::error_code error;
+    if (dataDir.empty() || !fs::is_directory(dataDir, error)) {
+        PrintUsage();
+        return g_exitUsage;
+    }
+
+    const auto categories = ParseDirectory<Category>(dataDir / "categories", "category", DataParser::ParseCategory);
+    const auto pools = ParseDirectory<VariantPool>(dataDir / "variantPools", "variant pool", DataParser::ParseVariantPool);
+    const auto resolved = DataMerge::ResolvePools(categories, pools);
+
+    PrintStatistics(categories, resolved);
+
+    if (!bundlePath.empty()) {
+        // only what the plugin would accept is compiled, so the bundle loads without errors
+        const auto acceptedPools = DataMerge::SelectBundlePools(categories, pools, resolved);
+
+        if (!PoolBundle::Write(bundlePath, categories, acceptedPools)) {
+            RedLogger::Error(std::format("Failed to write bundle {}.", bundlePath.string()));
+        }
+        else {
+            std::cout << std::format("wrote {} categories and {} variant pools to {}\n", categories.size(), acceptedPools.size(), bundlePath.string());
+        }
+    }
+
+    if (!indexPath.empty()) {
+        if (!WriteFileIndex(dataDir, indexPath)) {
+            RedLogger::Error(std::format("Failed to write file index {}.", indexPath.string()));
+        }
+        else {
+            std::cout << std::format("wrote the file index to {}\n", indexPath.string());
+        }
+    }
+
+    std::cout << std::format("{} errors, {} warnings\n", ConsoleLogger::ErrorCount(), ConsoleLogger::WarningCount());
+    return ConsoleLogger::ErrorCount() > 0 ? g_exitDataErrors : 0;
+}
@@ -0,0 +1,146 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "DirectoryWatcher.h"
+
+using namespace InfiniteRandomizerFramework;
+using namespace std::chrono_literals;
+using WaitResult = ChangeSource::WaitResult;
+
+namespace {
+    int g_failures = 0;
+
+    void Check(const bool condition, const char* what) {
+        if (!condition) {
+            std::printf("FAILED: %s\n", what);
+            g_failures++;
+        }
+    }
+
+    // polls instead of sleeping a fixed time, the watcher thread may be slow to get scheduled
+    template<typename Condition>
+    bool WaitFor(Condition condition, const std::chrono::milliseconds timeout = 5s) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!condition()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(5ms);
+        }
+        return true;
+    }
+
+    void Touch(const std::filesystem::path& path, const std::string& content) {
+        std::ofstream(path, std::ios::trunc) << content;
+    }
+
+    // reports a failure on every wait, like a change handle the system closed
+    class FailingChangeSource final : public ChangeSource {
+    public:
+        explicit FailingChangeSource(std::atomic<int>& waits) : m_waits(waits) {}
+
+        WaitResult Wait(std::chrono::milliseconds) override {
+            m_waits++;
+            return WaitResult::Failed;
+        }
+
+        void Wake() override {}
+
+    private:
+        std::atomic<int>& m_waits;
+    };
+
+    void TestChangeSource(const std::filesystem::path& directory) {
+        Check(ChangeSource::Create({directory / "missing"}) == nullptr, "a missing directory cannot be watched");
+
+        const auto source = ChangeSource::Create({directory});
+        Check(source != nullptr, "the directory can be watched");
+        if (!source) {
+            return;
+        }
+
+        Check(source->Wait(20ms) == WaitResult::Idle, "a quiet directory times out");
+
+        source->Wake();
+        Check(source->Wait(-1ms) == WaitResult::Idle, "a wake ends an unlimited wait without a change");
+
+        Touch(directory / "source.json", "{}");
+        Check(source->Wait(1s) == WaitResult::Changed, "writing a file is a change");
+        Check(source->Wait(20ms) == WaitResult::Idle, "the events of one change are drained at once");
+    }
+
+    void TestWatcherDebounces(const std::filesystem::path& directory) {
+        std::atomic<int> calls = 0;
+        DirectoryWatcher watcher(100ms);
+        Check(watcher.Start({directory}, [&calls] { calls++; return true; }), "the watcher starts");
+        Check(watcher.IsRunning(), "a started watcher runs");
+
+        for (auto i = 0; i < 5; i++) {
+            Touch(directory / "burst.json", std::to_string(i));
+            std::this_thread::sleep_for(10ms);
+        }
+
+        Check(WaitFor([&calls] { return calls > 0; }), "a burst of changes calls back");
+        std::this_thread::sleep_for(300ms);
+        Check(calls == 1, "a burst of changes calls back once");
+
+        Touch(directory / "later.json", "{}");
+        Check(WaitFor([&calls] { return calls > 1; }), "a later change calls back again");
+
+        watcher.Stop();
+        Check(!watcher.IsRunning(), "a stopped watcher does not run");
+        Check(!watcher.Failed(), "a stopped watcher did not fail");
+    }
+
+    void TestWatcherStopsFromCallback(const std::filesystem::path& directory) {
+        std::atomic<int> calls = 0;
+        DirectoryWatcher watcher(20ms);
+        watcher.Start({directory}, [&calls] { calls++; return false; });
+
+        Touch(directory / "stop.json", "{}");
+        Check(WaitFor([&watcher] { return !watcher.IsRunning(); }), "a callback returning false ends the watcher");
+        Check(calls == 1, "the ending callback is called once");
+
+        // the finished thread is joined by the next start
+        Check(watcher.Start({directory}, [] { return true; }), "an ended watcher starts again");
+        watcher.Stop();
+    }
+
+    void TestWatcherEndsOnFailure() {
+        std::atomic<int> waits = 0;
+        std::atomic<int> calls = 0;
+        DirectoryWatcher watcher(20ms);
+        watcher.Start(std::make_unique<FailingChangeSource>(waits), [&calls] { calls++; return true; });
+
+        Check(WaitFor([&watcher] { return !watcher.IsRunning(); }), "a failing source ends the watcher");
+        Check(watcher.Failed(), "the watcher reports the failure");
+        Check(waits == 1, "a failing source is not waited on again");
+        Check(calls == 0, "a failure without a change does not call back");
+        watcher.Stop();
+    }
+}
+
+int main() {
+    const auto directory = std::filesystem::temp_directory_path() / ("irf-watcher-test-" + std::to_string(getpid()));
+    std::filesystem::create_directories(directory);
+
+    TestChangeSource(directory);
+    TestWatcherDebounces(directory);
+    TestWatcherStopsFromCallback(directory);
+    TestWatcherEndsOnFailure();
+
+    std::filesystem::remove_all(directory);
+
+    if (g_failures > 0) {
+        std::printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+    std::printf("all checks passed\n");
+    return 0;
+}
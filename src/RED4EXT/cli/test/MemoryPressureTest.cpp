@@ -0,0 +1,89 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "MemoryPressure.h"
+
+using namespace InfiniteRandomizerFramework;
+using namespace std::chrono_literals;
+
+namespace {
+    int g_failures = 0;
+
+    void Check(const bool condition, const char* what) {
+        if (!condition) {
+            std::printf("FAILED: %s\n", what);
+            g_failures++;
+        }
+    }
+
+    // stands in for the engine pools, the sampler is a plain function pointer
+    std::atomic<float> g_level = 0.0f;
+    std::atomic<int> g_samples = 0;
+
+    float SampleFake() {
+        g_samples++;
+        return g_level.load();
+    }
+
+    void TestSampling() {
+        g_level = 0.5f;
+        g_samples = 0;
+        MemoryPressure pressure(&SampleFake);
+        Check(pressure.Current() == 0.5f, "the first read samples");
+
+        g_level = 0.9f;
+        Check(pressure.Current() == 0.5f, "a fresh sample is kept");
+        Check(g_samples == 1, "a fresh sample is not taken again");
+
+        // the sample interval is 250 ms
+        std::this_thread::sleep_for(300ms);
+        Check(pressure.Current() == 0.9f, "a stale sample is taken again");
+        Check(g_samples == 2, "a stale sample is taken once");
+    }
+
+    void TestClamping() {
+        g_level = 1.5f;
+        Check(MemoryPressure(&SampleFake).Current() == 1.0f, "a pool over its budget reads as full");
+
+        g_level = -0.25f;
+        Check(MemoryPressure(&SampleFake).Current() == 0.0f, "a negative sample reads as empty");
+    }
+
+    void TestFallbackChance() {
+        Check(MemoryPressure::FallbackChance(0.5f, 0.8f) == 0.0f, "nothing falls back below the threshold");
+        Check(MemoryPressure::FallbackChance(0.8f, 0.8f) == 0.0f, "nothing falls back at the threshold");
+        Check(MemoryPressure::FallbackChance(0.9f, 0.8f) > 0.49f && MemoryPressure::FallbackChance(0.9f, 0.8f) < 0.51f,
+              "halfway between the threshold and a full pool half the nodes fall back");
+        Check(MemoryPressure::FallbackChance(1.0f, 0.8f) == 1.0f, "every node falls back at a full pool");
+        Check(MemoryPressure::FallbackChance(1.0f, 1.0f) == 0.0f, "a threshold of 1 never falls back");
+        Check(MemoryPressure::FallbackChance(0.5f, 0.0f) == 0.5f, "a threshold of 0 follows the pressure");
+    }
+
+    void TestSamplerDrivesFallback() {
+        // the path the patcher takes, a sampled level mapped through the threshold of a resource kind
+        g_level = 0.95f;
+        MemoryPressure pressure(&SampleFake);
+        const auto chance = MemoryPressure::FallbackChance(pressure.Current(), 0.9f);
+        Check(chance > 0.49f && chance < 0.51f, "a sampled level past the threshold raises the fallback chance");
+
+        g_level = 0.2f;
+        Check(MemoryPressure::FallbackChance(MemoryPressure(&SampleFake).Current(), 0.9f) == 0.0f,
+              "a low sampled level keeps every node");
+    }
+}
+
+int main() {
+    TestSampling();
+    TestClamping();
+    TestFallbackChance();
+    TestSamplerDrivesFallback();
+
+    if (g_failures > 0) {
+        std::printf("%d checks failed\n", g_failures);
+        return 1;
+    }
+    std::printf("all checks passed\n");
+    return 0;
+}
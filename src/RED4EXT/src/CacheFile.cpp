@@ -0,0 +1,51 @@
+#include "CacheFile.h"
+
+#include <fstream>
+
+namespace InfiniteRandomizerFramework {
+    void CacheFile::Write(std::ostream& stream, const std::string& value) {
+        Write(stream, static_cast<uint32_t>(value.size()));
+        stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+
+    bool CacheFile::Read(std::istream& stream, std::string& value) {
+        uint32_t length = 0;
+        if (!ReadLength(stream, length)) {
+            return false;
+        }
+        value.resize(length);
+        return length == 0 || static_cast<bool>(stream.read(value.data(), length));
+    }
+
+    bool CacheFile::ReadLength(std::istream& stream, uint32_t& length, const uint32_t limit) {
+        return Read(stream, length) && length <= limit;
+    }
+
+    bool CacheFile::Save(const std::filesystem::path& path, const std::function<void(std::ostream&)>& write) {
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+
+        auto tempPath = path;
+        tempPath += ".tmp";
+
+        bool written;
+        {
+            std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+            if (!stream) {
+                return false;
+            }
+            write(stream);
+            stream.flush();
+            written = static_cast<bool>(stream);
+        }
+
+        if (written) {
+            std::filesystem::rename(tempPath, path, error);
+        }
+        if (!written || error) {
+            std::filesystem::remove(tempPath, error);
+            return false;
+        }
+        return true;
+    }
+}
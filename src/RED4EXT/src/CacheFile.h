@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+namespace InfiniteRandomizerFramework {
+    // binary files the plugin writes for itself, values are stored in native layout and only read back by the same build
+    class CacheFile {
+    public:
+        // guards against allocating absurd sizes from a corrupt file
+        static constexpr uint32_t MaxLength = 1 << 24;
+
+        template<typename T>
+        static void Write(std::ostream& stream, const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        static void Write(std::ostream& stream, const std::string& value);
+
+        template<typename T>
+        static bool Read(std::istream& stream, T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+        }
+
+        static bool Read(std::istream& stream, std::string& value);
+        // a length above the limit fails the read like a truncated file does
+        static bool ReadLength(std::istream& stream, uint32_t& length, uint32_t limit = MaxLength);
+
+        // writes next to the target and swaps the result in, a crash mid write never leaves a truncated file behind.
+        // the temporary file is removed again if writing or the swap fails
+        static bool Save(const std::filesystem::path& path, const std::function<void(std::ostream&)>& write);
+    };
+}
@@ -0,0 +1,75 @@
+#include "DataMerge.h"
+
+#include <format>
+
+#include "RedLogger.h"
+
+namespace InfiniteRandomizerFramework {
+    ResolvedPools DataMerge::ResolvePools(const std::unordered_map<std::string, Category>& categories,
+                                          const std::unordered_map<std::string, VariantPool>& pools) {
+        ResolvedPools resolved;
+
+        // categories are interned to dense ids, so the merge never has to hash or build strings
+        std::unordered_map<std::string_view, uint32_t> categoryIds;
+        categoryIds.reserve(categories.size());
+        resolved.categoryById.reserve(categories.size());
+        resolved.categoryNames.reserve(categories.size());
+        for (const auto& cat : categories) {
+            categoryIds.emplace(cat.first, static_cast<uint32_t>(resolved.categoryById.size()));
+            resolved.categoryById.push_back(&cat.second);
+            resolved.categoryNames.push_back(cat.first);
+        }
+
+        resolved.categoryEntries.resize(resolved.categoryById.size());
+        for (const auto& pool : pools) {
+            if (!pool.second.enabled) {
+                resolved.disabledPools++;
+                continue;
+            }
+
+            const auto catIdIt = categoryIds.find(pool.second.category);
+            if (catIdIt == categoryIds.end()) {
+                RedLogger::Error(std::format("Failed to load variant pool {}: target category {} does not exist.", pool.first, pool.second.category));
+                resolved.rejectedPools++;
+                continue;
+            }
+
+            const Category& targetCat = *resolved.categoryById[catIdIt->second];
+            if (targetCat.extension != pool.second.extension) {
+                RedLogger::Error(std::format("Failed to load variant pool {}: target category {} type ({}), does not match variant pool type ({}).", pool.first, pool.second.category, targetCat.extension, pool.second.extension));
+                resolved.rejectedPools++;
+                continue;
+            }
+
+            auto& entries = resolved.categoryEntries[catIdIt->second];
+            for (const auto& poolEntry : pool.second.entries) {
+                entries.push_back(&poolEntry);
+            }
+            resolved.loadedPools.emplace_back(&pool.first, catIdIt->second);
+        }
+
+        return resolved;
+    }
+
+    std::unordered_map<std::string, VariantPool> DataMerge::SelectBundlePools(const std::unordered_map<std::string, Category>& categories,
+                                                                              const std::unordered_map<std::string, VariantPool>& pools,
+                                                                              const ResolvedPools& resolved) {
+        std::unordered_map<std::string, VariantPool> bundlePools;
+        for (const auto& [name, catId] : resolved.loadedPools) {
+            bundlePools.emplace(*name, pools.at(*name));
+        }
+
+        // disabled pools are kept so players can still turn them on, they are resolved as if they were enabled so one
+        // that would fail once turned on is reported now and left out
+        std::unordered_map<std::string, VariantPool> disabledPools;
+        for (const auto& [name, pool] : pools) {
+            if (!pool.enabled) {
+                disabledPools.emplace(name, pool).first->second.enabled = true;
+            }
+        }
+        for (const auto& [name, catId] : ResolvePools(categories, disabledPools).loadedPools) {
+            bundlePools.emplace(*name, pools.at(*name));
+        }
+        return bundlePools;
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "DataStructs/Category.h"
+#include "DataStructs/VariantPool.h"
+
+namespace InfiniteRandomizerFramework {
+    // categories interned to dense ids together with the pool entries each of them receives
+    // points into the maps it was resolved from, which have to outlive it
+    struct ResolvedPools {
+        std::vector<std::string_view> categoryNames;
+        std::vector<const Category*> categoryById;
+        // pool entries per category id, weights are not yet accumulated
+        std::vector<std::vector<const VariantPoolEntry*>> categoryEntries;
+        // accepted pools and their category id
+        std::vector<std::pair<const std::string*, uint32_t>> loadedPools;
+        size_t rejectedPools = 0;
+        size_t disabledPools = 0;
+    };
+
+    // first step of merging parsed data, shared by the plugin and the offline compiler
+    class DataMerge {
+    public:
+        // pools whose category does not exist or holds a different resource type are logged and left out, disabled pools
+        // are left out silently
+        static ResolvedPools ResolvePools(const std::unordered_map<std::string, Category>& categories,
+                                          const std::unordered_map<std::string, VariantPool>& pools);
+        // the pools a bundle compiled from the parsed files holds: the accepted pools of `resolved` and the disabled
+        // pools that would be accepted once turned on, each with the enabled state of its file
+        static std::unordered_map<std::string, VariantPool> SelectBundlePools(const std::unordered_map<std::string, Category>& categories,
+                                                                              const std::unordered_map<std::string, VariantPool>& pools,
+                                                                              const ResolvedPools& resolved);
+    };
+}
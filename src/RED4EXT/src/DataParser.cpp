@@ -0,0 +1,275 @@
+#include "DataParser.h"
+
+#include <cmath>
+#include <filesystem>
+#include <format>
+
+#include <RapidJson/document.h>
+#include <RapidJson/error/en.h>
+
+#include "RedLogger.h"
+
+namespace fs = std::filesystem;
+
+namespace InfiniteRandomizerFramework {
+    namespace {
+        // what fs::path::extension yields, nothing for a path without one or a single dot followed by a file name part
+        bool IsExtension(const std::string& extension) {
+            return extension.empty()
+                || (extension.size() > 1 && extension[0] == '.' && extension.find_first_of(R"(./\)", 1) == std::string::npos);
+        }
+    }
+
+    bool DataParser::ValidateCategory(const std::string& displayPath, const Category& category) {
+        if (!IsExtension(category.extension)) {
+            RedLogger::Error(std::format("Category {} is malformed: `{}` is not a resource type.", displayPath, category.extension));
+            return false;
+        }
+        return true;
+    }
+
+    bool DataParser::ValidateVariantPool(const std::string& displayPath, const VariantPool& pool) {
+        if (!IsExtension(pool.extension)) {
+            RedLogger::Error(std::format("Variant pool {} is malformed: `{}` is not a resource type.", displayPath, pool.extension));
+            return false;
+        }
+        if (pool.category.empty()) {
+            RedLogger::Error(std::format("Variant pool {} is malformed: it names no category.", displayPath));
+            return false;
+        }
+        for (size_t i = 0; i < pool.entries.size(); i++) {
+            if (!std::isfinite(pool.entries[i].weight) || pool.entries[i].weight <= 0.0f) {
+                RedLogger::Error(std::format("Variant pool {} is malformed: weight of entry {} is not a positive number.", displayPath, i));
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool DataParser::ParseCategory(const std::string& displayPath, const std::string& content, std::string& name, Category& category) {
+        rapidjson::Document doc;
+        doc.Parse(content.c_str());
+
+        RedLogger::Info(std::format("Loading category {}", displayPath));
+
+        if (doc.HasParseError()) {
+            RedLogger::Error(std::format("Failed to parse category file with error {}.", rapidjson::GetParseError_En(doc.GetParseError())));
+            return false;
+        }
+
+        if (!doc.IsObject()) {
+            RedLogger::Error("Category file is malformed: root is not of type object.");
+            return false;
+        }
+
+        if (!doc.HasMember("name")) {
+            RedLogger::Error("Category file is malformed: missing property `name`.");
+            return false;
+        }
+
+        if (!doc["name"].IsString()) {
+            RedLogger::Error("Category file is malformed: property `name` is not of type string.");
+            return false;
+        }
+
+        name = doc["name"].GetString();
+
+        if (!doc.HasMember("entries")) {
+            RedLogger::Error("Category file is malformed: missing property `entries`.");
+            return false;
+        }
+
+        if (!doc["entries"].IsArray()) {
+            RedLogger::Error("Category file is malformed: property `entries` is not of type array.");
+            return false;
+        }
+
+        auto entries = doc["entries"].GetArray();
+        auto i = -1;
+        for (const auto& entry : entries) {
+            i++;
+            if (!entry.IsObject()) {
+                RedLogger::Warning(std::format("Category entry at {} is malformed: root is not of type object.", i));
+                continue;
+            }
+
+            if (!entry.HasMember("resourcePath")) {
+                RedLogger::Warning(std::format("Category entry at {} is malformed: missing property `resourcePath`.", i));
+                continue;
+            }
+
+            if (!entry["resourcePath"].IsString()) {
+                RedLogger::Warning(std::format("Category entry at {} is malformed: property `resourcePath` is not of type string.", i));
+                continue;
+            }
+
+            const auto resourcePathString = entry["resourcePath"].GetString();
+            const auto redResourcePath = RED4ext::ResourcePath(resourcePathString);
+            const auto extension = fs::path(resourcePathString).extension().string();
+
+            if (category.extension.empty()) {
+                category.extension = extension;
+            }
+
+            if (category.extension != extension) {
+                RedLogger::Error("Category file is malformed: entries contains mixed resource types");
+                return false;
+            }
+
+            auto catEntry = CategoryEntry();
+            catEntry.resourcePath = redResourcePath;
+
+            if (entry.HasMember("appearance")) {
+                if (entry["appearance"].IsString()) {
+                    catEntry.appearance = entry["appearance"].GetString();
+                }
+                else {
+                    RedLogger::Warning(std::format("Category entry at {} is malformed: property `appearance` is not of type string, using default.", i));
+                    catEntry.appearance = g_anyAppearance;
+                }
+            }
+            else {
+                catEntry.appearance = g_anyAppearance;
+            }
+
+            category.entries.push_back(catEntry);
+        }
+
+        return ValidateCategory(displayPath, category);
+    }
+
+    bool DataParser::ParseVariantPool(const std::string& displayPath, const std::string& content, std::string& name, VariantPool& pool) {
+        rapidjson::Document doc;
+        doc.Parse(content.c_str());
+
+        RedLogger::Info(std::format("Loading variant pool {}", displayPath));
+
+        if (doc.HasParseError()) {
+            RedLogger::Error(std::format("Failed to parse variant pool file with error {}.", rapidjson::GetParseError_En(doc.GetParseError())));
+            return false;
+        }
+
+        if (!doc.IsObject()) {
+            RedLogger::Error("Variant pool file is malformed: root is not of type object.");
+            return false;
+        }
+
+        if (!doc.HasMember("enabled")) {
+            RedLogger::Error("Variant pool file is malformed: missing property `enabled`.");
+            return false;
+        }
+
+        if (!doc["enabled"].IsBool()) {
+            RedLogger::Error("Variant pool file is malformed: property `enabled` is not of type bool.");
+            return false;
+        }
+
+        pool.enabled = doc["enabled"].GetBool();
+
+        if (!doc.HasMember("name")) {
+            RedLogger::Error("Variant pool file is malformed: missing property `name`.");
+            return false;
+        }
+
+        if (!doc["name"].IsString()) {
+            RedLogger::Error("Variant pool file is malformed: property `name` is not of type string.");
+            return false;
+        }
+
+        name = doc["name"].GetString();
+
+        if (!doc.HasMember("category")) {
+            RedLogger::Error("Variant pool file is malformed: missing property `category`.");
+            return false;
+        }
+
+        if (!doc["category"].IsString()) {
+            RedLogger::Error("Variant pool files is malformed: property `category` is not of type string.");
+            return false;
+        }
+
+        pool.category = doc["category"].GetString();
+
+        if (!doc.HasMember("variants")) {
+            RedLogger::Error("Variant pool file is malformed: missing property `variants`.");
+            return false;
+        }
+
+        if (!doc["variants"].IsArray()) {
+            RedLogger::Error("Variant pool file is malformed: property `variants` is not of type array.");
+            return false;
+        }
+
+        auto variantArray = doc["variants"].GetArray();
+        auto i = -1;
+        for (const auto& entry : variantArray) {
+            i++;
+            if (!entry.IsObject()) {
+                RedLogger::Error(std::format("Variant pool entry at {} is malformed: root is not of type object.", i));
+                continue;
+            }
+
+            if (!entry.HasMember("resourcePath")) {
+                RedLogger::Error(std::format("Variant pool entry at {} is malformed: missing property `resourcePath`.", i));
+                continue;
+            }
+
+            if (!entry["resourcePath"].IsString()) {
+                RedLogger::Error(std::format("Variant pool entry at {} is malformed: property `resourcePath` is not of type string.", i));
+                continue;
+            }
+
+            const auto resourcePathString = entry["resourcePath"].GetString();
+            const auto redResourcePath = RED4ext::ResourcePath(resourcePathString);
+            const auto extension = fs::path(resourcePathString).extension().string();
+
+            if (pool.extension.empty()) {
+                pool.extension = extension;
+            }
+
+            if (pool.extension != extension) {
+                RedLogger::Error("Category file is malformed: entries contains mixed resource types");
+                return false;
+            }
+
+            auto variant = VariantPoolEntry();
+            variant.resourcePath = redResourcePath;
+
+            if (entry.HasMember("weight")) {
+                if (entry["weight"].IsNumber()) {
+                    auto weight = entry["weight"].GetFloat();
+                    if (!std::isfinite(weight) || weight <= 0.0f) {
+                        RedLogger::Warning(std::format("Variant pool entry at {} is malformed: property `weight` must be bigger than 0, using default.", i));
+                        variant.weight = 1.0f;
+                    }
+                    else {
+                        variant.weight = weight;
+                    }
+                }
+                else {
+                    RedLogger::Warning(std::format("Variant pool entry at {} is malformed: property `weight` is not of type number, using default.", i));
+                    variant.weight = 1.0f;
+                }
+            }
+            else {
+                variant.weight = 1.0f;
+            }
+
+            if (entry.HasMember("appearance")) {
+                if (entry["appearance"].IsString()) {
+                    variant.appearance = entry["appearance"].GetString();
+                }
+                else {
+                    RedLogger::Warning(std::format("Variant pool entry at {} is malformed: property `appearance` is not of type string, using default.", i));
+                    variant.appearance = "default";
+                }
+            }
+            else {
+                variant.appearance = "default";
+            }
+            pool.entries.push_back(variant);
+        }
+
+        return ValidateVariantPool(displayPath, pool);
+    }
+}
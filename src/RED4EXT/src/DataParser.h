@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+
+#include "DataStructs/Category.h"
+#include "DataStructs/VariantPool.h"
+
+namespace InfiniteRandomizerFramework {
+    // turns the JSON of a single category or variant pool file into its parsed form, problems are logged
+    // shared by the plugin and the offline compiler
+    class DataParser {
+    public:
+        // returns false if the file does not yield a category
+        static bool ParseCategory(const std::string& displayPath, const std::string& content, std::string& name, Category& category);
+        // returns false if the file does not yield a variant pool, disabled pools are returned as such
+        static bool ParseVariantPool(const std::string& displayPath, const std::string& content, std::string& name, VariantPool& pool);
+
+        // the checks a parsed category or variant pool passes, also applied to ones read from a bundle. whether a pool
+        // matches the type of its category is checked when pools are resolved
+        static bool ValidateCategory(const std::string& displayPath, const Category& category);
+        static bool ValidateVariantPool(const std::string& displayPath, const VariantPool& pool);
+    };
+}
@@ -1,11 +1,14 @@
 #pragma once
 
+#include <string>
 #include <vector>
 
 #include "RED4ext/CName.hpp"
 #include "RED4ext/ResourcePath.hpp"
 
 namespace InfiniteRandomizerFramework {
+    // appearance of category entries that do not name one, they match every appearance
+    inline constexpr RED4ext::CName g_anyAppearance = "81bb7f86-8b76-4bc2-b6eb-f57039ef475a";
 
     struct CategoryEntry {
         RED4ext::ResourcePath resourcePath;
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "xxhash64.h"
+
+namespace InfiniteRandomizerFramework {
+
+    // sorted, duplicate free list of interned category ids a resource belongs to
+    // two resources with equal sets share the same combined replacement distribution
+    struct CategorySet {
+        std::vector<uint32_t> ids;
+
+        void Add(uint32_t id) {
+            const auto it = std::ranges::lower_bound(ids, id);
+            if (it != ids.end() && *it == id) {
+                return;
+            }
+            ids.insert(it, id);
+        }
+
+        bool operator==(const CategorySet& other) const {
+            return ids == other.ids;
+        }
+    };
+
+    struct CategorySetHash {
+        size_t operator()(const CategorySet& set) const {
+            return XXHash64::hash(set.ids.data(), set.ids.size() * sizeof(uint32_t), 0);
+        }
+    };
+}
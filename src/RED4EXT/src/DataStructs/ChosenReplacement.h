@@ -0,0 +1,11 @@
+#pragma once
+
+#include "RED4ext/ResourcePath.hpp"
+
+namespace InfiniteRandomizerFramework {
+
+    // a replacement a patched node references now, collected per sector for the prefetcher
+    struct ChosenReplacement {
+        RED4ext::ResourcePath resourcePath;
+    };
+}
@@ -7,5 +7,18 @@ namespace InfiniteRandomizerFramework
     extern RED4ext::PluginHandle g_pHandle;
     extern const RED4ext::Sdk* g_sdk;
     inline constexpr bool g_isDebug = false;
-    inline constexpr RED4ext::CName g_anyAppearance = "81bb7f86-8b76-4bc2-b6eb-f57039ef475a";
+    // candidates whose index lookups are kept in flight together while patching a sector
+    inline constexpr size_t g_probeGroupSize = 16;
+    // sectors with at least this many nodes are split into chunks that are patched on the job system
+    inline constexpr uint32_t g_parallelSectorThreshold = 16384;
+    inline constexpr uint32_t g_parallelChunkSize = 4096;
+    // sectors with replaceable nodes that are fully scanned to confirm their dependency list names every replaced path
+    // before the list alone is trusted to skip sectors
+    inline constexpr uint32_t g_dependencyListVerificationSectors = 32;
+    // finished replacement prefetches kept alive so the resources are still resident when their nodes spawn
+    inline constexpr size_t g_prefetchCapacity = 512;
+    // variant paths checked against the depot per job when validating pools
+    inline constexpr size_t g_validationChunkSize = 1024;
+    // quiet time after the last change in the data directories before they are reloaded
+    inline constexpr int64_t g_watchDebounceMs = 500;
 }
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace InfiniteRandomizerFramework {
+
+    // heap block header assumed per allocation when estimating allocator overhead
+    inline constexpr size_t g_allocationHeaderBytes = 16;
+
+    // node based containers allocate one node per element holding the value and the list links
+    template<typename K, typename V>
+    constexpr size_t HashNodeBytes() {
+        return sizeof(std::pair<const K, V>) + 2 * sizeof(void*);
+    }
+
+    struct MemoryReportEntry {
+        std::string name;
+        size_t bytes = 0;
+    };
+
+    struct MemoryReport {
+        size_t indexBytes = 0;
+        size_t replacementSetBytes = 0;
+        size_t appearanceNameBytes = 0;
+        size_t cacheBytes = 0;
+        size_t allocationCount = 0;
+        // per allocation headers plus reserved but unused container capacity
+        size_t allocatorOverheadBytes = 0;
+        std::vector<MemoryReportEntry> categories;
+        std::vector<MemoryReportEntry> pools;
+        std::vector<MemoryReportEntry> caches;
+
+        [[nodiscard]] size_t TotalBytes() const {
+            return indexBytes + replacementSetBytes + appearanceNameBytes + cacheBytes;
+        }
+    };
+}
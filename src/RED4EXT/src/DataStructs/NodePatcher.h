@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+
+#include "RED4ext/RTTITypes.hpp"
+
+namespace InfiniteRandomizerFramework {
+
+    inline constexpr uint32_t g_noAppearanceOffset = UINT32_MAX;
+
+    // what a node type references, swaps of some kinds cost far more memory than others
+    enum class ResourceKind : uint8_t {
+        Mesh,
+        Entity,
+        Material,
+        Count,
+    };
+
+    // names the resource reference and the optional appearance property of a node type
+    struct NodePatcherDefinition {
+        const char* className;
+        const char* resourceProperty;
+        const char* appearanceProperty;
+        ResourceKind kind;
+    };
+
+    // byte offsets into a node instance, resolved once through RTTI
+    struct NodePatcher {
+        const RED4ext::CClass* type;
+        uint32_t resourceOffset;
+        uint32_t appearanceOffset;
+        ResourceKind kind;
+    };
+}
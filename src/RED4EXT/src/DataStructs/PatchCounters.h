@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace InfiniteRandomizerFramework {
+
+    // running totals of the sector patching work, updated once per probe pass so chunks patched in parallel do not contend
+    struct PatchCounters {
+        std::atomic<uint64_t> sectors = 0;
+        // sectors whose dependency list named no replaceable path, their nodes were never visited
+        std::atomic<uint64_t> skippedSectors = 0;
+        std::atomic<uint64_t> lookups = 0;
+        std::atomic<uint64_t> lookupCacheHits = 0;
+        std::atomic<uint64_t> replacedNodes = 0;
+        std::atomic<uint64_t> prefetchRequests = 0;
+        // nodes that kept their original resource because of memory pressure
+        std::atomic<uint64_t> pressureFallbacks = 0;
+        // entries checked against the depot on their first draw
+        std::atomic<uint64_t> lazyValidations = 0;
+
+        void Reset() {
+            sectors = 0;
+            skippedSectors = 0;
+            lookups = 0;
+            lookupCacheHits = 0;
+            replacedNodes = 0;
+            prefetchRequests = 0;
+            pressureFallbacks = 0;
+            lazyValidations = 0;
+        }
+    };
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace InfiniteRandomizerFramework {
+
+    // what the overlay lists about every variant pool on disk, disabled ones included
+    struct PoolCatalogEntry {
+        std::string name;
+        std::string category;
+        bool enabled;
+        uint32_t variantCount;
+        // relative to the mod directory with forward slashes, as the CET mod opens files
+        std::string filePath;
+    };
+
+    // fields per pool in the flat string array handed to scripts
+    inline constexpr uint32_t g_poolCatalogStride = 5;
+}
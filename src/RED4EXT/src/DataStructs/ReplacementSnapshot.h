@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+#include "PerfectHashIndex.h"
+#include "DataStructs/MemoryReport.h"
+#include "DataStructs/PoolCatalog.h"
+#include "DataStructs/Replacements.h"
+#include "DataStructs/Settings.h"
+
+namespace InfiniteRandomizerFramework {
+
+    // immutable result of a single load, published as a whole so sector patching never observes a half built state
+    struct ReplacementSnapshot {
+        PerfectHashIndex index;
+        // indexed by the slot the index returns for a resource path hash
+        std::vector<AppearanceReplacements> slots;
+        // identifies the set of replaceable paths, sector manifest entries recorded for another set are stale
+        uint64_t keySetHash = 0;
+        // identifies the archives the depot served at load time, manifest entries recorded for other archives are stale
+        uint64_t archiveFingerprint = 0;
+        // read with the data it was loaded alongside, so a reload switches both at once
+        Settings settings;
+        // every pool found on disk when this state was loaded, for the overlay
+        std::vector<PoolCatalogEntry> poolCatalog;
+        // bytes attributed to each category and pool while merging, the totals are measured on demand
+        std::vector<MemoryReportEntry> categoryUsage;
+        std::vector<MemoryReportEntry> poolUsage;
+        // caches owned by the loading thread, measured when this state was loaded since a reload may change them at any time
+        std::vector<MemoryReportEntry> loaderCaches;
+
+        [[nodiscard]] const AppearanceReplacements* Find(uint64_t resourcePathHash) const {
+            const auto slot = index.Find(resourcePathHash);
+            return slot == PerfectHashIndex::npos ? nullptr : &slots[slot];
+        }
+
+        void PrefetchSlot(uint32_t slot) const {
+            index.PrefetchSlot(slot);
+            _mm_prefetch(reinterpret_cast<const char*>(&slots[slot]), _MM_HINT_T0);
+        }
+    };
+}
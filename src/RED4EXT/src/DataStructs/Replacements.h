@@ -1,11 +1,21 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "RED4ext/CName.hpp"
 
 namespace InfiniteRandomizerFramework
 {
+enum class EntryState : uint8_t
+{
+    Unchecked,
+    Valid,
+    Invalid,
+};
+
 struct Replacements
 {
     // weights[0] is reserved for the sum of all individual weights
@@ -13,5 +23,26 @@ struct Replacements
     std::unique_ptr<std::vector<float>> weights;
     std::unique_ptr<std::vector<RED4ext::CName>> appNames;
     std::unique_ptr<std::vector<RED4ext::ResourcePath>> resourcePaths;
+    // id of the category each entry was contributed by
+    std::unique_ptr<std::vector<uint32_t>> categoryIds;
+    // whether each entry points to an existing resource, only consulted when resources are validated lazily
+    std::unique_ptr<std::vector<std::atomic<EntryState>>> entryStates;
+    // how often each entry was selected while resident replacements are preferred, and the sum of those over a
+    // sliding window. lets the resident boost be withheld from entries already above their configured share
+    std::unique_ptr<std::vector<std::atomic<uint32_t>>> selections;
+    mutable std::atomic<uint32_t> selectionCount = 0;
+    // laid out like weights with the entries lazy validation found invalid cut to a width of 0, so draws no longer land
+    // on them. replaced as a whole by every cut, set once the first entry is cut
+    mutable std::atomic<std::shared_ptr<const std::vector<float>>> validWeights;
+    mutable std::atomic<bool> hasInvalidEntries = false;
 };
+
+// one entry of a replacement set, an empty set means nothing was drawn
+struct ReplacementEntry
+{
+    const Replacements* set = nullptr;
+    size_t index = 0;
+};
+
+using AppearanceReplacements = std::unordered_map<RED4ext::CName, std::shared_ptr<Replacements>>;
 }
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+#include "RED4ext/CName.hpp"
+#include "DataStructs/NodePatcher.h"
+#include "DataStructs/Replacements.h"
+
+namespace InfiniteRandomizerFramework {
+
+    // a node of a supported type gathered from a sector, resolved against the index in a later pass
+    struct SectorCandidate {
+        uint32_t nodeIndex;
+        const NodePatcher* patcher;
+        uint64_t resourcePathHash;
+        RED4ext::CName appearance;
+        const AppearanceReplacements* replacement;
+    };
+}
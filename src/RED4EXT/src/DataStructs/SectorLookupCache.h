@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "DataStructs/Replacements.h"
+
+namespace InfiniteRandomizerFramework {
+
+    // direct mapped cache of index results for the paths a sector references, small enough to live on the stack.
+    // sectors repeat the same meshes many times over, a repeated path is then resolved from L1 instead of the index
+    class SectorLookupCache {
+    public:
+        static constexpr size_t capacity = 64;
+
+        // a cached miss is reported as found with a null replacement
+        bool TryGet(const uint64_t resourcePathHash, const AppearanceReplacements*& replacement) const {
+            const auto& entry = m_entries[SlotOf(resourcePathHash)];
+            if (!entry.valid || entry.resourcePathHash != resourcePathHash) {
+                return false;
+            }
+
+            replacement = entry.replacement;
+            return true;
+        }
+
+        void Put(const uint64_t resourcePathHash, const AppearanceReplacements* replacement) {
+            m_entries[SlotOf(resourcePathHash)] = {resourcePathHash, replacement, true};
+        }
+
+    private:
+        struct Entry {
+            uint64_t resourcePathHash;
+            const AppearanceReplacements* replacement;
+            bool valid;
+        };
+
+        static size_t SlotOf(const uint64_t resourcePathHash) {
+            // path hashes are FNV-1a, folding the high half in spreads paths that only differ in their tail
+            return (resourcePathHash ^ (resourcePathHash >> 32)) & (capacity - 1);
+        }
+
+        Entry m_entries[capacity]{};
+    };
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "VarietyBudget.h"
+#include "DataStructs/NodePatcher.h"
+#include "DataStructs/Replacements.h"
+
+namespace InfiniteRandomizerFramework {
+
+    // selections a set remembers for its resident boost, halved whenever they reach it so later draws weigh more
+    constexpr uint32_t g_selectionWindow = 1 << 12;
+
+    // inputs to variant selection beyond the configured weights, built once per sector. the defaults select by weight alone
+    struct SelectionPolicy {
+        // sorted replacement paths the resource loader already holds, null when residency is not considered
+        const std::vector<uint64_t>* residentPaths = nullptr;
+        // weight multiplier for resident replacements below their configured share, entries above it are divided by it
+        // instead. in the long run every entry is selected close to its configured share, residency decides the order
+        float residentWeightBoost = 1.0f;
+        // null when variety is not limited
+        VarietyBudget* varietyBudget = nullptr;
+        // variants this sector acquired from the budget
+        std::vector<VarietyBudget::LiveVariant>* liveVariants = nullptr;
+        // chance a node keeps its original resource, per kind, raised as memory pressure passes its threshold
+        float fallbackChance[static_cast<size_t>(ResourceKind::Count)] = {};
+        // entries were admitted without checking the depot, drawn ones are validated and invalid ones excluded
+        bool validateLazily = false;
+
+        [[nodiscard]] float FallbackChance(const ResourceKind kind) const {
+            return fallbackChance[static_cast<size_t>(kind)];
+        }
+
+        [[nodiscard]] bool IsDefault() const {
+            return !residentPaths && !varietyBudget;
+        }
+
+        [[nodiscard]] float WeightOf(const Replacements& set, const size_t i, const float weight) const {
+            return WeightOf(set, i, weight, nullptr);
+        }
+
+        // asks the variety budget through admissions taken beforehand when given, instead of taking its lock per entry
+        [[nodiscard]] float WeightOf(const Replacements& set, const size_t i, const float weight,
+                                     const VarietyBudget::Admissions* admissions) const {
+            const auto resourcePath = set.resourcePaths->at(i).hash;
+            if (validateLazily && (*set.entryStates)[i].load(std::memory_order_relaxed) == EntryState::Invalid) {
+                return 0.0f;
+            }
+            if (varietyBudget) {
+                const auto categoryId = set.categoryIds->at(i);
+                if (admissions ? !admissions->Allows(categoryId, resourcePath) : !varietyBudget->Allows(categoryId, resourcePath)) {
+                    return 0.0f;
+                }
+            }
+            if (residentPaths) {
+                // selections * total weight > weight * all selections, without dividing by either
+                const auto selected = static_cast<float>((*set.selections)[i].load(std::memory_order_relaxed));
+                const auto setSelected = static_cast<float>(set.selectionCount.load(std::memory_order_relaxed));
+                if (selected * set.weights->at(0) > weight * setSelected) {
+                    return weight / residentWeightBoost;
+                }
+                if (std::ranges::binary_search(*residentPaths, resourcePath)) {
+                    return weight * residentWeightBoost;
+                }
+            }
+            return weight;
+        }
+
+        // no entry weighs more than its configured weight times this
+        [[nodiscard]] float MaxWeightFactor() const {
+            return residentPaths ? residentWeightBoost : 1.0f;
+        }
+
+        // false when the variety budget no longer admits the entry, it weighs 0 from then on and is drawn again
+        [[nodiscard]] bool OnSelected(const Replacements& set, const size_t i) const {
+            if (varietyBudget && !varietyBudget->Acquire(set.categoryIds->at(i), set.resourcePaths->at(i).hash, *liveVariants)) {
+                return false;
+            }
+            if (residentPaths) {
+                (*set.selections)[i].fetch_add(1, std::memory_order_relaxed);
+                // one thread sees the window fill up. selections made while it halves may lose a count, the shares stay close
+                if (set.selectionCount.fetch_add(1, std::memory_order_relaxed) + 1 == g_selectionWindow) {
+                    for (auto& selections : *set.selections) {
+                        selections.store(selections.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+                    }
+                    set.selectionCount.fetch_sub(g_selectionWindow / 2, std::memory_order_relaxed);
+                }
+            }
+            return true;
+        }
+    };
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+#include "DataStructs/NodePatcher.h"
+
+namespace InfiniteRandomizerFramework {
+
+    // optional behaviour read from data/settings.json, everything defaults to off
+    struct Settings {
+        // request the chosen replacements from the resource loader as soon as a sector is patched
+        bool prefetchReplacements = false;
+        // weight replacements the resource loader already holds higher, trading some variety for fewer cold reads
+        bool preferResidentReplacements = false;
+        float residentWeightBoost = 4.0f;
+        // distinct variants per category that may be live in loaded sectors at once, 0 for no limit
+        uint32_t categoryVarietyLimit = 0;
+        // admit variants without asking the depot at load, each is checked the first time it is drawn instead
+        bool validateResourcesLazily = false;
+        // fall back to original resources as engine memory pools fill up, entity swaps are given up first
+        bool degradeUnderMemoryPressure = false;
+        // pool usage at which each resource kind starts falling back, by the time a pool is full every node does
+        float memoryPressureThresholds[static_cast<size_t>(ResourceKind::Count)] = {0.9f, 0.8f, 0.95f};
+        // reload categories and variant pools on a background thread whenever their files change
+        bool watchForChanges = false;
+        // list data files from an index kept in the cache while their directory is unchanged, instead of enumerating it.
+        // each listed file is still looked at once for the parse cache, so this only pays off where enumeration is slow,
+        // such as a mod manager's virtual file system. irfc --index rebuilds the index from there after installing mods
+        bool useFileIndex = false;
+    };
+}
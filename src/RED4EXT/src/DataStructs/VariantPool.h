@@ -1,5 +1,6 @@
 #pragma once
 
+#include <string>
 #include <vector>
 #include "RED4ext/ResourcePath.hpp"
 
@@ -15,5 +16,7 @@ namespace InfiniteRandomizerFramework {
         std::string extension;
         std::string category;
         std::vector<VariantPoolEntry> entries;
+        // disabled pools are parsed so they can be listed, they are left out of the merge
+        bool enabled = true;
     };
 }
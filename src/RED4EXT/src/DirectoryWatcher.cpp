@@ -0,0 +1,233 @@
+#include "DirectoryWatcher.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace InfiniteRandomizerFramework {
+    namespace {
+#ifdef _WIN32
+        class NotificationChangeSource final : public ChangeSource {
+        public:
+            bool Open(const std::vector<std::filesystem::path>& directories) {
+                m_wakeEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+                if (!m_wakeEvent || directories.size() >= MAXIMUM_WAIT_OBJECTS) {
+                    return false;
+                }
+
+                for (const auto& directory : directories) {
+                    const auto handle = FindFirstChangeNotificationW(directory.c_str(), FALSE,
+                        FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+                    if (handle == INVALID_HANDLE_VALUE) {
+                        return false;
+                    }
+                    m_handles.push_back(handle);
+                }
+                m_handles.push_back(m_wakeEvent);
+                return true;
+            }
+
+            ~NotificationChangeSource() override {
+                for (const auto handle : m_handles) {
+                    if (handle != m_wakeEvent) {
+                        FindCloseChangeNotification(handle);
+                    }
+                }
+                if (m_wakeEvent) {
+                    CloseHandle(m_wakeEvent);
+                }
+            }
+
+            WaitResult Wait(const std::chrono::milliseconds timeout) override {
+                const auto result = WaitForMultipleObjects(static_cast<DWORD>(m_handles.size()), m_handles.data(), FALSE,
+                    timeout.count() < 0 ? INFINITE : static_cast<DWORD>(timeout.count()));
+                if (result == WAIT_TIMEOUT) {
+                    return WaitResult::Idle;
+                }
+
+                // the wake event is the last handle, anything past the handles is a failure
+                const auto index = static_cast<size_t>(result - WAIT_OBJECT_0);
+                if (index == m_handles.size() - 1) {
+                    return WaitResult::Idle;
+                }
+                if (index >= m_handles.size() || !FindNextChangeNotification(m_handles[index])) {
+                    return WaitResult::Failed;
+                }
+                return WaitResult::Changed;
+            }
+
+            void Wake() override {
+                SetEvent(m_wakeEvent);
+            }
+
+        private:
+            HANDLE m_wakeEvent = nullptr;
+            std::vector<HANDLE> m_handles;
+        };
+#elif defined(__linux__)
+        class InotifyChangeSource final : public ChangeSource {
+        public:
+            bool Open(const std::vector<std::filesystem::path>& directories) {
+                m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+                m_wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+                if (m_inotify < 0 || m_wake < 0) {
+                    return false;
+                }
+
+                for (const auto& directory : directories) {
+                    if (inotify_add_watch(m_inotify, directory.c_str(),
+                        IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO) < 0) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            ~InotifyChangeSource() override {
+                if (m_inotify >= 0) {
+                    close(m_inotify);
+                }
+                if (m_wake >= 0) {
+                    close(m_wake);
+                }
+            }
+
+            WaitResult Wait(const std::chrono::milliseconds timeout) override {
+                pollfd fds[2] = {{m_inotify, POLLIN, 0}, {m_wake, POLLIN, 0}};
+                const auto ready = poll(fds, 2, timeout.count() < 0 ? -1 : static_cast<int>(timeout.count()));
+                if (ready == 0 || (ready < 0 && errno == EINTR)) {
+                    return WaitResult::Idle;
+                }
+                if (ready < 0 || ((fds[0].revents | fds[1].revents) & (POLLERR | POLLNVAL))) {
+                    return WaitResult::Failed;
+                }
+
+                if (fds[1].revents & POLLIN) {
+                    uint64_t value = 0;
+                    read(m_wake, &value, sizeof(value));
+                }
+                if (!(fds[0].revents & POLLIN)) {
+                    return WaitResult::Idle;
+                }
+
+                // only the fact that something changed matters, the events themselves are drained
+                alignas(inotify_event) char buffer[4096];
+                while (read(m_inotify, buffer, sizeof(buffer)) > 0) {
+                }
+                return WaitResult::Changed;
+            }
+
+            void Wake() override {
+                const uint64_t value = 1;
+                write(m_wake, &value, sizeof(value));
+            }
+
+        private:
+            int m_inotify = -1;
+            int m_wake = -1;
+        };
+#endif
+    }
+
+    std::unique_ptr<ChangeSource> ChangeSource::Create(const std::vector<std::filesystem::path>& directories) {
+#ifdef _WIN32
+        auto source = std::make_unique<NotificationChangeSource>();
+#elif defined(__linux__)
+        auto source = std::make_unique<InotifyChangeSource>();
+#else
+        return nullptr;
+#endif
+        if (!source->Open(directories)) {
+            return nullptr;
+        }
+        return source;
+    }
+
+    DirectoryWatcher::~DirectoryWatcher() {
+        Stop();
+    }
+
+    bool DirectoryWatcher::Start(const std::vector<std::filesystem::path>& directories, Callback onChanged) {
+        if (IsRunning()) {
+            return true;
+        }
+        return Start(ChangeSource::Create(directories), std::move(onChanged));
+    }
+
+    bool DirectoryWatcher::Start(std::unique_ptr<ChangeSource> source, Callback onChanged) {
+        std::lock_guard lock(m_mutex);
+        if (m_running) {
+            return true;
+        }
+
+        // a watcher whose callback asked to stop leaves its finished thread behind
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+
+        m_source = std::move(source);
+        if (!m_source) {
+            return false;
+        }
+
+        m_onChanged = std::move(onChanged);
+        m_stopping = false;
+        m_failed = false;
+        m_running = true;
+        m_thread = std::thread(&DirectoryWatcher::Run, this);
+        return true;
+    }
+
+    void DirectoryWatcher::Stop() {
+        std::lock_guard lock(m_mutex);
+        if (m_thread.joinable()) {
+            m_stopping = true;
+            m_source->Wake();
+            m_thread.join();
+        }
+        m_source.reset();
+        m_running = false;
+    }
+
+    bool DirectoryWatcher::IsRunning() const {
+        return m_running;
+    }
+
+    bool DirectoryWatcher::Failed() const {
+        return m_failed;
+    }
+
+    void DirectoryWatcher::Run() {
+        using WaitResult = ChangeSource::WaitResult;
+
+        while (!m_stopping) {
+            auto result = m_source->Wait(std::chrono::milliseconds(-1));
+            if (result == WaitResult::Idle) {
+                continue;
+            }
+            // waiting on a broken source again would return at once and spin
+            if (result == WaitResult::Failed) {
+                m_failed = true;
+                break;
+            }
+
+            // an editor saving a file or a pack being copied in produces a burst of changes, wait for it to settle
+            while (!m_stopping && result == WaitResult::Changed) {
+                result = m_source->Wait(m_debounce);
+            }
+
+            // a source that broke while settling still delivers the changes it saw
+            m_failed = result == WaitResult::Failed;
+            if (m_stopping || !m_onChanged() || m_failed) {
+                break;
+            }
+        }
+        m_running = false;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace InfiniteRandomizerFramework {
+    // the notification api of the platform, only reports that something in the watched directories changed
+    class ChangeSource {
+    public:
+        enum class WaitResult {
+            Changed,
+            // the timeout passed or Wake was called
+            Idle,
+            // the notifications broke, waiting again would return at once
+            Failed,
+        };
+
+        virtual ~ChangeSource() = default;
+
+        // blocks until a change arrives, the timeout passes or Wake is called. a negative timeout waits without limit
+        virtual WaitResult Wait(std::chrono::milliseconds timeout) = 0;
+        virtual void Wake() = 0;
+
+        // inotify on linux, change notifications on windows, null if the directories cannot be watched
+        static std::unique_ptr<ChangeSource> Create(const std::vector<std::filesystem::path>& directories);
+    };
+
+    // calls back on its own thread once changes in the watched directories have settled for the debounce window.
+    // the watcher ends on its own if the notifications fail
+    class DirectoryWatcher {
+    public:
+        // returns whether to keep watching
+        using Callback = std::function<bool()>;
+
+        explicit DirectoryWatcher(std::chrono::milliseconds debounce) : m_debounce(debounce) {}
+        ~DirectoryWatcher();
+
+        bool Start(const std::vector<std::filesystem::path>& directories, Callback onChanged);
+        // watches whatever the source reports, false for a null source
+        bool Start(std::unique_ptr<ChangeSource> source, Callback onChanged);
+        // must not be called from the callback, return false from it instead
+        void Stop();
+        [[nodiscard]] bool IsRunning() const;
+        // whether the last run ended because the notifications failed
+        [[nodiscard]] bool Failed() const;
+
+    private:
+        void Run();
+
+        std::chrono::milliseconds m_debounce;
+        mutable std::mutex m_mutex;
+        std::unique_ptr<ChangeSource> m_source;
+        Callback m_onChanged;
+        std::thread m_thread;
+        std::atomic<bool> m_stopping = false;
+        std::atomic<bool> m_running = false;
+        std::atomic<bool> m_failed = false;
+    };
+}
@@ -12,6 +12,19 @@ namespace InfiniteRandomizerFramework {
         return min + (state % (max - min));
     }
 
+    FastRNG FastRNG::split() {
+        xorshift32();
+        // murmur3 finalizer so neighbouring streams do not start on correlated states
+        uint32_t seed = state;
+        seed ^= seed >> 16;
+        seed *= 0x85ebca6b;
+        seed ^= seed >> 13;
+        seed *= 0xc2b2ae35;
+        seed ^= seed >> 16;
+        // xorshift never leaves the zero state
+        return FastRNG{seed ? seed : 0x9e3779b9};
+    }
+
     float FastRNG::getFloat(const float max, const float min) {
         xorshift32();
         return min + (max - min) * state * (1.0f / 4294967296.0f);
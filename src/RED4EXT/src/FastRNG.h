@@ -7,5 +7,7 @@ namespace InfiniteRandomizerFramework {
         void xorshift32();
         uint32_t getInt32(uint32_t max, uint32_t min = 0);
         float getFloat(float max, float min = 0);
+        // independent stream for another thread, advances this generator once
+        FastRNG split();
     };
 }
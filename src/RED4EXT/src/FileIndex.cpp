@@ -0,0 +1,118 @@
+#include "FileIndex.h"
+
+#include <fstream>
+
+#include "CacheFile.h"
+
+namespace InfiniteRandomizerFramework {
+    namespace {
+        constexpr uint32_t g_fileIndexMagic = 0x49465249; // IRFI
+        constexpr uint32_t g_fileIndexVersion = 3;
+    }
+
+    bool FileIndex::TryGet(const std::filesystem::path& directory, const int64_t writeTime, std::vector<std::string>& names) const {
+        const auto it = m_entries.find(directory.filename().string());
+        if (it == m_entries.end() || it->second.unreliable || it->second.writeTime != writeTime) {
+            return false;
+        }
+
+        names = it->second.names;
+        return true;
+    }
+
+    void FileIndex::Store(const std::filesystem::path& directory, const int64_t writeTime, std::vector<std::string> names) {
+        auto& entry = m_entries[directory.filename().string()];
+        if (entry.unreliable) {
+            return;
+        }
+        entry.writeTime = writeTime;
+        entry.names = std::move(names);
+        m_dirty = true;
+    }
+
+    void FileIndex::MarkUnreliable(const std::filesystem::path& directory) {
+        auto& entry = m_entries[directory.filename().string()];
+        entry.unreliable = true;
+        entry.names.clear();
+        m_dirty = true;
+    }
+
+    bool FileIndex::Load(const std::filesystem::path& path) {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream) {
+            return false;
+        }
+
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint32_t count = 0;
+        if (!CacheFile::Read(stream, magic) || !CacheFile::Read(stream, version) || !CacheFile::ReadLength(stream, count)
+            || magic != g_fileIndexMagic || version != g_fileIndexVersion) {
+            return false;
+        }
+
+        std::unordered_map<std::string, Entry> entries;
+        for (uint32_t i = 0; i < count; i++) {
+            std::string directory;
+            uint8_t unreliable = 0;
+            uint32_t nameCount = 0;
+            Entry entry{};
+            if (!CacheFile::Read(stream, directory) || !CacheFile::Read(stream, entry.writeTime) || !CacheFile::Read(stream, unreliable)
+                || !CacheFile::ReadLength(stream, nameCount)) {
+                return false;
+            }
+            entry.unreliable = unreliable != 0;
+
+            entry.names.resize(nameCount);
+            for (auto& name : entry.names) {
+                if (!CacheFile::Read(stream, name)) {
+                    return false;
+                }
+            }
+            entries.insert_or_assign(std::move(directory), std::move(entry));
+        }
+
+        m_entries = std::move(entries);
+        m_dirty = false;
+        return true;
+    }
+
+    bool FileIndex::Save(const std::filesystem::path& path) {
+        if (!m_dirty) {
+            return true;
+        }
+
+        const auto saved = CacheFile::Save(path, [this](std::ostream& stream) {
+            CacheFile::Write(stream, g_fileIndexMagic);
+            CacheFile::Write(stream, g_fileIndexVersion);
+            CacheFile::Write(stream, static_cast<uint32_t>(m_entries.size()));
+            for (const auto& [directory, entry] : m_entries) {
+                CacheFile::Write(stream, directory);
+                CacheFile::Write(stream, entry.writeTime);
+                CacheFile::Write(stream, static_cast<uint8_t>(entry.unreliable));
+                CacheFile::Write(stream, static_cast<uint32_t>(entry.names.size()));
+                for (const auto& name : entry.names) {
+                    CacheFile::Write(stream, name);
+                }
+            }
+        });
+        if (!saved) {
+            return false;
+        }
+
+        m_dirty = false;
+        return true;
+    }
+
+    size_t FileIndex::MemoryUsage() const {
+        size_t bytes = m_entries.bucket_count() * 2 * sizeof(void*);
+        for (const auto& [directory, entry] : m_entries) {
+            bytes += sizeof(std::pair<const std::string, Entry>) + 2 * sizeof(void*) + directory.capacity()
+                + entry.names.capacity() * sizeof(std::string);
+            for (const auto& name : entry.names) {
+                bytes += name.capacity();
+            }
+        }
+        return bytes;
+    }
+}
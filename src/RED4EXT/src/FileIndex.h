@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace InfiniteRandomizerFramework {
+    // remembers the names of the data files of each directory as of the directory's last write time
+    // adding, removing or renaming a file changes that time, so a matching time means the list is still complete.
+    // directories are keyed by name, so an index written by the offline compiler for the same data directory is used
+    // as is. the files themselves are not fingerprinted, the parse cache looks at each listed file anyway.
+    // only used by the loading thread
+    class FileIndex {
+    public:
+        // copies the recorded names, returns false if the directory changed since they were recorded or is not trusted
+        bool TryGet(const std::filesystem::path& directory, int64_t writeTime, std::vector<std::string>& names) const;
+        void Store(const std::filesystem::path& directory, int64_t writeTime, std::vector<std::string> names);
+        // a recorded file vanished while the directory time stayed the same, as under some virtual file systems of
+        // mod managers. the directory is enumerated from now on, until an index is written without this one
+        void MarkUnreliable(const std::filesystem::path& directory);
+
+        bool Load(const std::filesystem::path& path);
+        bool Save(const std::filesystem::path& path);
+
+        [[nodiscard]] size_t MemoryUsage() const;
+
+    private:
+        struct Entry {
+            int64_t writeTime;
+            bool unreliable;
+            std::vector<std::string> names;
+        };
+
+        std::unordered_map<std::string, Entry> m_entries;
+        bool m_dirty = false;
+    };
+}
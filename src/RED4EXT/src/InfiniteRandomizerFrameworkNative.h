@@ -1,11 +1,35 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
+
 #include "FastRNG.h"
+#include "DirectoryWatcher.h"
+#include "FileIndex.h"
+#include "MemoryPressure.h"
+#include "ParseCache.h"
+#include "PoolStateOverlay.h"
+#include "ResidencyCache.h"
+#include "ResourcePrefetcher.h"
+#include "ResourceValidationCache.h"
+#include "SectorManifest.h"
+#include "VarietyBudget.h"
+#include "DataStructs/Globals.h"
 #include "DataStructs/Category.h"
 #include "DataStructs/VariantPool.h"
+#include "DataStructs/PoolCatalog.h"
 #include "DataStructs/Replacements.h"
+#include "DataStructs/ReplacementSnapshot.h"
+#include "DataStructs/NodePatcher.h"
+#include "DataStructs/SectorCandidate.h"
+#include "DataStructs/PatchCounters.h"
+#include "DataStructs/ChosenReplacement.h"
+#include "DataStructs/SelectionPolicy.h"
 #include "RED4ext/ResourceDepot.hpp"
 #include "RED4ext/RTTISystem.hpp"
+#include "RED4ext/ISerializable.hpp"
+#include "RED4ext/Scripting/Natives/Generated/world/Node.hpp"
+#include "RED4ext/Scripting/Natives/Generated/world/StreamingSector.hpp"
 #include "RED4ext/Scripting/IScriptable.hpp"
 #include "RED4ext/Scripting/Stack.hpp"
 
@@ -20,20 +44,130 @@ public:
     static void LoadFromDisk(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame, RED4ext::CString* aOut,
                       int64_t a4);
     std::tuple<RED4ext::ResourcePath, RED4ext::CName>
-    static GetRandomEntry(const RED4ext::ResourcePath &resourcePath,
-                   const RED4ext::CName &appearance);
+    static GetRandomEntry(const AppearanceReplacements &replacement,
+                   const RED4ext::CName &appearance, FastRNG &rng);
+    std::tuple<RED4ext::ResourcePath, RED4ext::CName>
+    static GetRandomEntry(const AppearanceReplacements &replacement,
+                   const RED4ext::CName &appearance, FastRNG &rng, const SelectionPolicy &policy);
+    static ReplacementEntry DrawEntry(const AppearanceReplacements &replacement,
+                   const RED4ext::CName &appearance, FastRNG &rng);
+    static ReplacementEntry DrawEntry(const AppearanceReplacements &replacement,
+                   const RED4ext::CName &appearance, FastRNG &rng, const SelectionPolicy &policy);
     static void OnSectorPostLoad(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame, RED4ext::CString* aOut,
                           int64_t a4);
+    static void IsNativePostLoadActive(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame, RED4ext::CString* aOut,
+                          int64_t a4);
+    static void GetMemoryReport(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame, RED4ext::CString* aOut,
+                          int64_t a4);
+    static void GetPoolCatalog(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame, RED4ext::CString* aOut,
+                          int64_t a4);
+    static void ExportBundle(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame, RED4ext::CString* aOut,
+                          int64_t a4);
+    static void SetPoolEnabled(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame, RED4ext::CString* aOut,
+                          int64_t a4);
+    static void SaveSectorManifest();
+    static void StopWatchingDataFiles();
+    static void UnhookSectorPostLoad();
     RED4ext::CClass* GetNativeType();
 private:
+    enum class DependencyScan {
+        // the loader holds no usable dependency list for the sector, its nodes have to be scanned
+        Unavailable,
+        NoReplaceablePaths,
+        HasReplaceablePaths,
+    };
+
     static inline bool m_initialized = false;
-    static inline std::unordered_map<uint64_t, std::unordered_map<RED4ext::CName, std::shared_ptr<Replacements>>> m_replacements;
+    static inline std::atomic<std::shared_ptr<const ReplacementSnapshot>> m_snapshot;
     static inline RED4ext::ResourceDepot* m_depot = std::nullptr_t();
     static inline RED4ext::CRTTISystem* m_rttis = std::nullptr_t();
-    static inline FastRNG m_rng = FastRNG();
+    // sectors are patched on several loader threads at once, every thread draws from its own stream
+    static inline std::atomic<uint32_t> m_rngSeed = 0;
+    static inline std::atomic<uint32_t> m_rngStreams = 0;
+    static inline SectorManifest m_sectorManifest;
+    static inline ParseCache m_parseCache;
+    static inline FileIndex m_fileIndex;
+    static inline PoolStateOverlay m_poolStates;
+    static inline std::mutex m_loadMutex;
+    static inline DirectoryWatcher m_dataWatcher{std::chrono::milliseconds(g_watchDebounceMs)};
+    // keyed by every registered node class and all classes derived from them
+    static inline std::unordered_map<const RED4ext::CClass*, NodePatcher> m_nodePatchers;
+    static inline PatchCounters m_patchCounters;
+    static inline ResourcePrefetcher m_prefetcher{g_prefetchCapacity};
+    static inline VarietyBudget m_varietyBudget;
+    static inline ResidencyCache m_residencyCache;
+    static inline MemoryPressure m_memoryPressure;
+    // kept across reloads, toggling a pool only queries the depot for paths it has not seen with these archives
+    static inline ResourceValidationCache m_validationCache;
+    static inline RED4ext::CClass* m_sectorType = nullptr;
+    static inline void* m_sectorPostLoadTarget = nullptr;
+    static inline void (*m_originalSectorPostLoad)(RED4ext::ISerializable*, const RED4ext::PostLoadParams&) = nullptr;
+    static inline bool m_nativePostLoadHooked = false;
+    static inline void* m_sectorDestructorTarget = nullptr;
+    static inline void* (*m_originalSectorDestructor)(RED4ext::ISerializable*, uint32_t) = nullptr;
+    static inline bool m_sectorDestructorHooked = false;
+    // sectors that confirmed their dependency list, and whether a sector ever contradicted it
+    static inline std::atomic<uint32_t> m_dependencyListConfirmations = 0;
+    static inline std::atomic<bool> m_dependencyListUnreliable = false;
     static void LoadFromDiskInternal();
-    static std::unordered_map<std::string, Category> LoadCategoriesFromDisk();
-    static std::unordered_map<std::string, VariantPool> LoadVariantPoolsFromDisk();
+    // starts or stops watching the data directories to match the published settings
+    static void UpdateWatcher();
+    static bool OnDataFilesChanged();
+    static const std::filesystem::path& GetModDir();
+    static std::filesystem::path GetSectorManifestPath();
+    static std::filesystem::path GetParseCachePath();
+    static std::filesystem::path GetFileIndexPath();
+    static std::filesystem::path GetPoolStatesPath();
+    static std::string GetModRelativePath(const std::filesystem::path& path);
+    static Settings LoadSettingsFromDisk();
+    // json files of a data directory, listed from the file index while the directory is unchanged
+    static std::vector<std::filesystem::directory_entry> DiscoverDataFiles(const std::filesystem::path& directory, bool useFileIndex);
+    static std::unordered_map<std::string, Category> LoadCategoriesFromDisk(bool useFileIndex);
+    // every parsed pool is added to the catalog if one is given, only pools enabled after applying the pool states are returned
+    static std::unordered_map<std::string, VariantPool> LoadVariantPoolsFromDisk(bool useFileIndex,
+                                                                                 std::vector<PoolCatalogEntry>* catalog);
+    static std::filesystem::path GetBundleDir();
+    static void LoadBundlesFromDisk(std::unordered_map<std::string, Category>& categories,
+                                    std::unordered_map<std::string, VariantPool>& pools,
+                                    std::vector<PoolCatalogEntry>* catalog);
+    static void ValidateVariantPools(std::unordered_map<std::string, VariantPool>& pools);
+    static bool ValidateEntry(const ReplacementEntry& entry);
+    static bool HookSectorPostLoad();
+    static void OnSectorPostLoadDetour(RED4ext::ISerializable* aResource, const RED4ext::PostLoadParams& aParams);
+    static void* OnSectorDestructorDetour(RED4ext::ISerializable* aResource, uint32_t aFlags);
+    static void PatchSector(RED4ext::worldStreamingSector* sector);
+    static DependencyScan ScanSectorDependencies(const ReplacementSnapshot& snapshot, RED4ext::ResourcePath sectorPath,
+                                                 std::vector<uint64_t>& dependencyPaths);
+    static void VerifySectorDependencies(const std::vector<SectorCandidate>& candidates,
+                                         const std::vector<uint64_t>& dependencyPaths);
+    static void RegisterNodePatchers();
+    // the calling thread's generator, seeded from m_rngSeed and its own stream number on first use
+    static FastRNG& ThreadRng();
+    static void GatherCandidate(const RED4ext::DynArray<RED4ext::Handle<RED4ext::worldNode>>& nodes,
+                                uint32_t i, std::vector<SectorCandidate>& candidates);
+    static void GatherCandidates(const RED4ext::DynArray<RED4ext::Handle<RED4ext::worldNode>>& nodes,
+                                 uint32_t begin, uint32_t end, std::vector<SectorCandidate>& candidates);
+    static void GatherCandidates(const RED4ext::DynArray<RED4ext::Handle<RED4ext::worldNode>>& nodes,
+                                 const std::vector<uint32_t>& nodeIndices, std::vector<SectorCandidate>& candidates);
+    static void CollectHits(const std::vector<SectorCandidate>& candidates, std::vector<uint32_t>& nodeIndices);
+    static void ProbeCandidates(const ReplacementSnapshot& snapshot, std::vector<SectorCandidate>& candidates);
+    static void ApplyCandidates(const RED4ext::DynArray<RED4ext::Handle<RED4ext::worldNode>>& nodes,
+                                const std::vector<SectorCandidate>& candidates, FastRNG& rng,
+                                const SelectionPolicy& policy, std::vector<ChosenReplacement>& chosen);
+    static SelectionPolicy BuildSelectionPolicy(const ReplacementSnapshot& snapshot,
+                                                const std::vector<SectorCandidate>& candidates,
+                                                std::vector<uint64_t>& residentPaths,
+                                                std::vector<VarietyBudget::LiveVariant>& liveVariants);
+    static void TrackLiveVariants(const ReplacementSnapshot& snapshot, RED4ext::worldStreamingSector* sector,
+                                  std::vector<VarietyBudget::LiveVariant> liveVariants);
+    static void CollectResidentPaths(const std::vector<SectorCandidate>& candidates, std::vector<uint64_t>& residentPaths);
+    static void PatchNodesParallel(const ReplacementSnapshot& snapshot,
+                                   const RED4ext::DynArray<RED4ext::Handle<RED4ext::worldNode>>& nodes,
+                                   std::vector<uint32_t>& hitIndices, std::vector<ChosenReplacement>& chosen,
+                                   std::vector<VarietyBudget::LiveVariant>& liveVariants);
+    static void PrefetchReplacements(const std::vector<ChosenReplacement>& chosen);
+    static MemoryReport MeasureMemory(const ReplacementSnapshot& snapshot);
+    static void LogMemoryReport(const MemoryReport& report);
 };
 
 }
@@ -0,0 +1,156 @@
+#include <format>
+#include <fstream>
+#include <sstream>
+
+#include "InfiniteRandomizerFrameworkNative.h"
+
+#include "DataMerge.h"
+#include "DataParser.h"
+#include "MappedFile.h"
+#include "PoolBundle.h"
+#include "RedLogger.h"
+#include "RED4ext/Scripting/Utils.hpp"
+
+namespace fs = std::filesystem;
+
+namespace InfiniteRandomizerFramework {
+
+namespace {
+// every json file of the directory as it is on disk, without the parse cache or the pool states
+template<typename T, typename Parse>
+std::unordered_map<std::string, T> ParseDataDirectory(const fs::path& directory, const char* kind, Parse parse) {
+    std::unordered_map<std::string, T> parsed;
+    for (const auto& file : fs::directory_iterator(directory)) {
+        if (file.path().extension() != ".json" || !file.is_regular_file()) {
+            continue;
+        }
+
+        const auto displayPath = file.path().filename().string();
+        std::ifstream fileStream(file.path(), std::ios::binary);
+        if (!fileStream) {
+            RedLogger::Error(std::format("Failed to open {}.", displayPath));
+            continue;
+        }
+        std::stringstream buffer;
+        buffer << fileStream.rdbuf();
+
+        std::string name;
+        T value{};
+        if (!parse(displayPath, buffer.str(), name, value)) {
+            continue;
+        }
+        if (!parsed.try_emplace(name, std::move(value)).second) {
+            RedLogger::Error(std::format("Failed to load {} {} from {}: {} with conflicting name exists.", kind, name, displayPath, kind));
+        }
+    }
+    return parsed;
+}
+}
+
+std::filesystem::path InfiniteRandomizerFrameworkNative::GetBundleDir() {
+    return GetModDir() / R"(data\bundles)";
+}
+
+void InfiniteRandomizerFrameworkNative::LoadBundlesFromDisk(std::unordered_map<std::string, Category>& categories,
+                                                            std::unordered_map<std::string, VariantPool>& pools,
+                                                            std::vector<PoolCatalogEntry>* catalog) {
+    const auto bundleDir = GetBundleDir();
+    std::error_code error;
+    if (!fs::is_directory(bundleDir, error)) {
+        return;
+    }
+
+    try
+    {
+    for (const auto& bundleFile : fs::directory_iterator(bundleDir)) {
+        if (bundleFile.path().extension() != PoolBundle::Extension || !bundleFile.is_regular_file()) {
+            continue;
+        }
+
+        const auto displayPath = bundleFile.path().filename().string();
+        MappedFile file;
+        std::vector<std::pair<std::string, Category>> bundleCategories;
+        std::vector<std::pair<std::string, VariantPool>> bundlePools;
+        if (!file.Open(bundleFile.path()) || !PoolBundle::Read(file.Data(), file.Size(), bundleCategories, bundlePools)) {
+            RedLogger::Error(std::format("Failed to load bundle {}: file is unreadable or malformed.", displayPath));
+            continue;
+        }
+
+        RedLogger::Info(std::format("Loading bundle {} with {} categories and {} variant pools", displayPath,
+            bundleCategories.size(), bundlePools.size()));
+
+        // a bundle is only checked for its structure, each record is held to the rules of the JSON file it stands for
+        for (auto& [name, category] : bundleCategories) {
+            if (!DataParser::ValidateCategory(std::format("{} in bundle {}", name, displayPath), category)) {
+                continue;
+            }
+            if (!categories.try_emplace(name, std::move(category)).second) {
+                RedLogger::Error(std::format("Failed to load category {} from bundle {}: category with conflicting name exists.", name, displayPath));
+            }
+        }
+
+        const auto filePath = GetModRelativePath(bundleFile.path());
+        for (auto& [name, pool] : bundlePools) {
+            if (!DataParser::ValidateVariantPool(std::format("{} in bundle {}", name, displayPath), pool)) {
+                continue;
+            }
+            pool.enabled = m_poolStates.IsEnabled(name, pool.enabled);
+            if (catalog) {
+                catalog->push_back({name, pool.category, pool.enabled, static_cast<uint32_t>(pool.entries.size()), filePath});
+            }
+
+            if (!pool.enabled) {
+                continue;
+            }
+
+            if (!pools.try_emplace(name, std::move(pool)).second) {
+                RedLogger::Error(std::format("Failed to load variant pool {} from bundle {}: variant pool with conflicting name exists.", name, displayPath));
+            }
+        }
+    }
+    }
+    catch (const std::exception& e)
+    {
+    RedLogger::Error(std::format("Failed to load bundles from disk with error: {}", e.what()));
+    }
+}
+
+void InfiniteRandomizerFrameworkNative::ExportBundle(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame, RED4ext::CString* aOut, int64_t a4) {
+    RED4ext::CString name;
+    RED4ext::GetParameter(aFrame, &name);
+    aFrame->code++;
+
+    const std::string bundleName = name.c_str();
+    bool written = false;
+    if (bundleName.empty() || bundleName.find_first_of(R"(\/:*?"<>|)") != std::string::npos) {
+        RedLogger::Error(std::format("Failed to export bundle: `{}` is not a valid file name.", bundleName));
+    }
+    else {
+        // the JSON files are converted as they are on disk, not the published state which may include other bundles
+        // or the pool states of the overlay. each pool keeps the enabled state of its file, like irfc --bundle
+        const auto path = GetModDir() / "export" / (bundleName + PoolBundle::Extension);
+        try
+        {
+        const auto categories = ParseDataDirectory<Category>(GetModDir() / R"(data\categories)", "category", DataParser::ParseCategory);
+        const auto pools = ParseDataDirectory<VariantPool>(GetModDir() / R"(data\variantPools)", "variant pool", DataParser::ParseVariantPool);
+        const auto bundlePools = DataMerge::SelectBundlePools(categories, pools, DataMerge::ResolvePools(categories, pools));
+        written = PoolBundle::Write(path, categories, bundlePools);
+        if (written) {
+            RedLogger::Info(std::format("Exported {} categories and {} variant pools to {}, move it to data\\bundles in place of the JSON files",
+                categories.size(), bundlePools.size(), path.string()));
+        }
+        else {
+            RedLogger::Error(std::format("Failed to write bundle {}.", path.string()));
+        }
+        }
+        catch (const std::exception& e)
+        {
+        RedLogger::Error(std::format("Failed to export bundle {} with error: {}", path.string(), e.what()));
+        }
+    }
+
+    if (aOut) {
+        *reinterpret_cast<bool*>(aOut) = written;
+    }
+}
+}
@@ -0,0 +1,93 @@
+#include "InfiniteRandomizerFrameworkNative.h"
+
+#include "DataStructs/Globals.h"
+#include "RedLogger.h"
+
+namespace InfiniteRandomizerFramework {
+
+namespace {
+    // ISerializable::PostLoad and the deleting destructor, see RED4ext/ISerializable.hpp
+    constexpr size_t g_postLoadVtableIndex = 0x28 / sizeof(void*);
+    constexpr size_t g_destructorVtableIndex = 0x18 / sizeof(void*);
+}
+
+bool InfiniteRandomizerFrameworkNative::HookSectorPostLoad() {
+    if (m_nativePostLoadHooked) {
+        return true;
+    }
+
+    m_sectorType = m_rttis->GetClass("worldStreamingSector");
+    if (!m_sectorType) {
+        return false;
+    }
+
+    // the SDK has no loader wide listener for loaded resources, ResourceToken::OnLoaded only reports tokens the plugin
+    // requested itself and the Resource/PostLoad callback system is only reachable from scripts, which is the fallback.
+    // the vtable is only reachable through an instance, a throwaway sector is enough to read it
+    const RED4ext::Handle<RED4ext::ISerializable> probe(
+        reinterpret_cast<RED4ext::ISerializable*>(m_sectorType->CreateInstance(true)));
+    if (!probe) {
+        return false;
+    }
+
+    const auto* vtable = *reinterpret_cast<void***>(probe.GetPtr());
+    m_sectorPostLoadTarget = vtable[g_postLoadVtableIndex];
+    m_nativePostLoadHooked = g_sdk->hooking->Attach(g_pHandle, m_sectorPostLoadTarget,
+        reinterpret_cast<void*>(&OnSectorPostLoadDetour), reinterpret_cast<void**>(&m_originalSectorPostLoad));
+
+    // the SDK has no unload event either. sectors are destroyed once the streamer lets go of them, which frees their
+    // variety budget slots right away instead of at the next sweep of expired handles
+    if (m_nativePostLoadHooked) {
+        m_sectorDestructorTarget = vtable[g_destructorVtableIndex];
+        m_sectorDestructorHooked = g_sdk->hooking->Attach(g_pHandle, m_sectorDestructorTarget,
+            reinterpret_cast<void*>(&OnSectorDestructorDetour), reinterpret_cast<void**>(&m_originalSectorDestructor));
+        if (!m_sectorDestructorHooked) {
+            RedLogger::Warning("Failed to hook sector destruction, unloaded sectors release variety slots on the next patched sector");
+        }
+    }
+
+    return m_nativePostLoadHooked;
+}
+
+void InfiniteRandomizerFrameworkNative::UnhookSectorPostLoad() {
+    if (!m_nativePostLoadHooked) {
+        return;
+    }
+
+    g_sdk->hooking->Detach(g_pHandle, m_sectorPostLoadTarget);
+    m_nativePostLoadHooked = false;
+
+    if (m_sectorDestructorHooked) {
+        g_sdk->hooking->Detach(g_pHandle, m_sectorDestructorTarget);
+        m_sectorDestructorHooked = false;
+    }
+}
+
+void InfiniteRandomizerFrameworkNative::OnSectorPostLoadDetour(RED4ext::ISerializable* aResource, const RED4ext::PostLoadParams& aParams) {
+    m_originalSectorPostLoad(aResource, aParams);
+
+    // the slot can be inherited, so other resource types may share the hooked function
+    if (aResource->GetNativeType() != m_sectorType) {
+        return;
+    }
+
+    PatchSector(static_cast<RED4ext::worldStreamingSector*>(aResource));
+}
+
+void* InfiniteRandomizerFrameworkNative::OnSectorDestructorDetour(RED4ext::ISerializable* aResource, const uint32_t aFlags) {
+    // the slot can be inherited as well, the instance is still intact before the original runs
+    if (aResource->GetNativeType() == m_sectorType) {
+        m_varietyBudget.Release(aResource);
+    }
+
+    return m_originalSectorDestructor(aResource, aFlags);
+}
+
+void InfiniteRandomizerFrameworkNative::IsNativePostLoadActive(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame, RED4ext::CString* aOut, int64_t a4) {
+    aFrame->code++;
+
+    if (aOut) {
+        *reinterpret_cast<bool*>(aOut) = m_nativePostLoadHooked;
+    }
+}
+}
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <format>
+#include <unordered_set>
+
+#include "InfiniteRandomizerFrameworkNative.h"
+
+#include "RedLogger.h"
+
+namespace InfiniteRandomizerFramework {
+
+namespace {
+    // make_shared control block ahead of the object
+    constexpr size_t g_sharedControlBlockBytes = 16;
+
+    std::string FormatBytes(const size_t bytes) {
+        if (bytes >= 1024 * 1024) {
+            return std::format("{:.2f} MiB", bytes / (1024.0 * 1024.0));
+        }
+        if (bytes >= 1024) {
+            return std::format("{:.2f} KiB", bytes / 1024.0);
+        }
+        return std::format("{} B", bytes);
+    }
+
+    template<typename T>
+    void MeasureVector(const std::vector<T>& vector, size_t& bytes, MemoryReport& report) {
+        bytes += vector.size() * sizeof(T);
+        report.allocatorOverheadBytes += (vector.capacity() - vector.size()) * sizeof(T);
+        if (vector.capacity() > 0) {
+            report.allocationCount++;
+        }
+    }
+
+    void AppendPatchCounters(std::string& out, const PatchCounters& counters, const size_t liveVariants) {
+        const auto lookups = counters.lookups.load(std::memory_order_relaxed);
+        const auto cacheHits = counters.lookupCacheHits.load(std::memory_order_relaxed);
+
+        out += "Sector patching:\n";
+        out += std::format("  Sectors: {}\n", counters.sectors.load(std::memory_order_relaxed));
+        out += std::format("  Skipped by dependency list: {}\n", counters.skippedSectors.load(std::memory_order_relaxed));
+        out += std::format("  Node lookups: {}\n", lookups);
+        out += std::format("  Sector lookup cache hits: {} ({:.1f}%)\n", cacheHits,
+            lookups > 0 ? 100.0 * cacheHits / lookups : 0.0);
+        out += std::format("  Replaced nodes: {}\n", counters.replacedNodes.load(std::memory_order_relaxed));
+        out += std::format("  Prefetch requests: {}\n", counters.prefetchRequests.load(std::memory_order_relaxed));
+        out += std::format("  Live budgeted variants: {}\n", liveVariants);
+        out += std::format("  Memory pressure fallbacks: {}\n", counters.pressureFallbacks.load(std::memory_order_relaxed));
+        out += std::format("  Lazily validated entries: {}\n", counters.lazyValidations.load(std::memory_order_relaxed));
+    }
+
+    void AppendEntries(std::string& out, const char* title, std::vector<MemoryReportEntry> entries) {
+        std::ranges::sort(entries, [](const MemoryReportEntry& a, const MemoryReportEntry& b) {
+            return a.bytes > b.bytes;
+        });
+
+        out += std::format("{} ({}):\n", title, entries.size());
+        for (const auto& entry : entries) {
+            out += std::format("  {}: {}\n", entry.name, FormatBytes(entry.bytes));
+        }
+    }
+}
+
+MemoryReport InfiniteRandomizerFrameworkNative::MeasureMemory(const ReplacementSnapshot& snapshot) {
+    MemoryReport report;
+
+    report.indexBytes = snapshot.index.MemoryUsage();
+    report.allocationCount += 3;
+    MeasureVector(snapshot.slots, report.indexBytes, report);
+
+    std::unordered_set<const Replacements*> measuredSets;
+    for (const auto& appMap : snapshot.slots) {
+        report.appearanceNameBytes += appMap.size() * HashNodeBytes<RED4ext::CName, std::shared_ptr<Replacements>>()
+            + appMap.bucket_count() * 2 * sizeof(void*);
+        report.allocationCount += appMap.size() + 1;
+
+        for (const auto& replacement : appMap) {
+            if (!measuredSets.insert(replacement.second.get()).second) {
+                continue;
+            }
+
+            report.replacementSetBytes += g_sharedControlBlockBytes + sizeof(Replacements)
+                + 6 * sizeof(std::vector<float>);
+            report.allocationCount += 7;
+            MeasureVector(*replacement.second->weights, report.replacementSetBytes, report);
+            MeasureVector(*replacement.second->resourcePaths, report.replacementSetBytes, report);
+            MeasureVector(*replacement.second->categoryIds, report.replacementSetBytes, report);
+            MeasureVector(*replacement.second->entryStates, report.replacementSetBytes, report);
+            MeasureVector(*replacement.second->selections, report.replacementSetBytes, report);
+            MeasureVector(*replacement.second->appNames, report.appearanceNameBytes, report);
+            if (const auto validWeights = replacement.second->validWeights.load()) {
+                report.replacementSetBytes += g_sharedControlBlockBytes + sizeof(std::vector<float>);
+                report.allocationCount++;
+                MeasureVector(*validWeights, report.replacementSetBytes, report);
+            }
+        }
+    }
+
+    report.caches.push_back({"Sector manifest", m_sectorManifest.MemoryUsage()});
+    report.caches.insert(report.caches.end(), snapshot.loaderCaches.begin(), snapshot.loaderCaches.end());
+    report.caches.push_back({"Replacement prefetches", m_prefetcher.MemoryUsage()});
+    report.caches.push_back({"Variety budget", m_varietyBudget.MemoryUsage()});
+    report.caches.push_back({"Resident replacements", m_residencyCache.MemoryUsage()});
+    report.caches.push_back({"Resource validation", m_validationCache.MemoryUsage()});
+    for (const auto& cache : report.caches) {
+        report.cacheBytes += cache.bytes;
+    }
+
+    report.allocatorOverheadBytes += report.allocationCount * g_allocationHeaderBytes;
+    report.categories = snapshot.categoryUsage;
+    report.pools = snapshot.poolUsage;
+
+    return report;
+}
+
+void InfiniteRandomizerFrameworkNative::LogMemoryReport(const MemoryReport& report) {
+    RedLogger::Info(std::format("Memory usage: {} total, index {}, replacement sets {}, appearance names {}, caches {}",
+        FormatBytes(report.TotalBytes()), FormatBytes(report.indexBytes), FormatBytes(report.replacementSetBytes),
+        FormatBytes(report.appearanceNameBytes), FormatBytes(report.cacheBytes)));
+    RedLogger::Info(std::format("Estimated allocator overhead: {} across {} allocations",
+        FormatBytes(report.allocatorOverheadBytes), report.allocationCount));
+}
+
+void InfiniteRandomizerFrameworkNative::GetMemoryReport(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame, RED4ext::CString* aOut, int64_t a4) {
+    aFrame->code++;
+
+    const auto snapshot = m_snapshot.load();
+    if (!snapshot) {
+        if (aOut) {
+            *aOut = RED4ext::CString("No replacement state loaded.");
+        }
+        return;
+    }
+
+    const auto report = MeasureMemory(*snapshot);
+
+    std::string out;
+    out += std::format("Total: {}\n", FormatBytes(report.TotalBytes()));
+    out += std::format("Index: {}\n", FormatBytes(report.indexBytes));
+    out += std::format("Replacement sets: {}\n", FormatBytes(report.replacementSetBytes));
+    out += std::format("Appearance names: {}\n", FormatBytes(report.appearanceNameBytes));
+    out += std::format("Caches: {}\n", FormatBytes(report.cacheBytes));
+    out += std::format("Allocator overhead (estimated, not in total): {} across {} allocations\n",
+        FormatBytes(report.allocatorOverheadBytes), report.allocationCount);
+    AppendEntries(out, "Caches", report.caches);
+    AppendPatchCounters(out, m_patchCounters, m_varietyBudget.LiveCount());
+    out += std::format("Engine memory pressure: {:.1f}%\n", 100.0f * m_memoryPressure.Current());
+    AppendEntries(out, "Categories (index entries)", report.categories);
+    AppendEntries(out, "Variant pools (replacement set entries)", report.pools);
+
+    if (aOut) {
+        *aOut = RED4ext::CString(out.c_str());
+    }
+}
+}
@@ -1,146 +1,746 @@
+#include <algorithm>
+#include <format>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <shared_mutex>
 
 #include "InfiniteRandomizerFrameworkNative.h"
 
+#include "ParallelJobs.h"
 #include "DataStructs/Globals.h"
+#include "DataStructs/SectorLookupCache.h"
 #include "DataStructs/StreamingSectorNodeBuffer.h"
-#include "RED4ext/Scripting/Natives/Generated/world/BendedMeshNode.hpp"
-#include "RED4ext/Scripting/Natives/Generated/world/EntityNode.hpp"
-#include "RED4ext/Scripting/Natives/Generated/world/FoliageNode.hpp"
-#include "RED4ext/Scripting/Natives/Generated/world/InstancedMeshNode.hpp"
-#include "RED4ext/Scripting/Natives/Generated/world/MeshNode.hpp"
-#include "RED4ext/Scripting/Natives/Generated/world/StaticDecalNode.hpp"
 #include "RED4ext/Scripting/Natives/Generated/world/StreamingSector.hpp"
-#include "RED4ext/Scripting/Natives/Generated/world/TerrainMeshNode.hpp"
+#include "RED4ext/ResourceLoader.hpp"
 #include "RED4ext/Scripting/Utils.hpp"
 #include "RedLib.hpp"
 #include "RedLogger.h"
 
 namespace InfiniteRandomizerFramework {
 
-std::tuple<RED4ext::ResourcePath, RED4ext::CName>
-InfiniteRandomizerFrameworkNative::GetRandomEntry(
-    const RED4ext::ResourcePath &resourcePath,
-    const RED4ext::CName &appearance) {
+namespace {
+    // node types that are randomized, adding a type only needs an entry here
+    constexpr NodePatcherDefinition g_nodePatcherDefinitions[] = {
+        {"worldMeshNode", "mesh", "meshAppearance", ResourceKind::Mesh},
+        {"worldInstancedMeshNode", "mesh", "meshAppearance", ResourceKind::Mesh},
+        {"worldBendedMeshNode", "mesh", "meshAppearance", ResourceKind::Mesh},
+        {"worldFoliageNode", "mesh", "meshAppearance", ResourceKind::Mesh},
+        {"worldTerrainMeshNode", "meshRef", nullptr, ResourceKind::Mesh},
+        {"worldEntityNode", "entityTemplate", "appearanceName", ResourceKind::Entity},
+        {"worldStaticDecalNode", "material", nullptr, ResourceKind::Material},
+    };
+
+    // draws that may be rejected before a policy draw sums every weight instead
+    constexpr int g_policyDrawAttempts = 8;
+
+    float EntryWeight(const std::vector<float>& weights, const size_t i) {
+        return weights[i + 1] - (i == 0 ? 0.0f : weights[i]);
+    }
+
+    float EntryWeight(const Replacements& set, const size_t i) {
+        return EntryWeight(*set.weights, i);
+    }
+
+    // the cumulative weights draws search, sets without invalid entries hand out their own without taking a reference
+    std::shared_ptr<const std::vector<float>> DrawWeights(const Replacements& set) {
+        if (set.hasInvalidEntries.load(std::memory_order_acquire)) {
+            return set.validWeights.load();
+        }
+        return {std::shared_ptr<const void>(), set.weights.get()};
+    }
+
+    // removes an invalid entry from the distribution, threads cutting entries of the same set retry on each other's result
+    void CutEntry(const Replacements& set, const size_t index) {
+        auto current = set.validWeights.load();
+        std::shared_ptr<const std::vector<float>> cut;
+        do {
+            const auto& weights = current ? *current : *set.weights;
+            if (EntryWeight(weights, index) <= 0.0f) {
+                return;
+            }
 
-    const auto& replacement = m_replacements.at(resourcePath);
+            // summed again rather than shifted, so repeated cuts do not accumulate rounding errors
+            auto rebuilt = std::make_shared<std::vector<float>>(weights.size());
+            float weightSum = 0.0f;
+            for (size_t i = 0; i + 1 < weights.size(); i++) {
+                weightSum += i == index ? 0.0f : EntryWeight(weights, i);
+                (*rebuilt)[i + 1] = weightSum;
+            }
+            (*rebuilt)[0] = weightSum;
+            cut = std::move(rebuilt);
+        } while (!set.validWeights.compare_exchange_weak(current, cut));
+
+        set.hasInvalidEntries.store(true, std::memory_order_release);
+    }
+}
+
+ReplacementEntry InfiniteRandomizerFrameworkNative::DrawEntry(
+    const AppearanceReplacements &replacement,
+    const RED4ext::CName &appearance, FastRNG &rng) {
 
     const auto& anyReplacements = replacement.at(g_anyAppearance);
+    const auto anyWeights = DrawWeights(*anyReplacements);
     float randWeight;
 
     if (replacement.contains(appearance)) {
         const auto& appReplacements = replacement.at(appearance);
+        const auto appWeights = DrawWeights(*appReplacements);
 
-        randWeight = m_rng.getFloat(anyReplacements->weights->at(0) +
-                                               appReplacements->weights->at(0));
+        const auto totalWeight = anyWeights->at(0) + appWeights->at(0);
+        // every entry was cut
+        if (totalWeight <= 0.0f) {
+            return {};
+        }
+        randWeight = rng.getFloat(totalWeight);
 
-        for (auto i = 1; i < appReplacements->weights->size(); i++) {
-            if (randWeight <= appReplacements->weights->at(i)) {
-                return std::tuple(appReplacements->resourcePaths->at(i - 1),
-                    appReplacements->appNames->at(i - 1));
-            }
+        // the draw is never 0, so entries cut to a width of 0 cannot be found
+        const auto& weights = *appWeights;
+        if (const auto it = std::lower_bound(weights.begin() + 1, weights.end(), randWeight); it != weights.end()) {
+            return {appReplacements.get(), static_cast<size_t>(it - weights.begin() - 1)};
         }
+
+        // the draw landed past the appearance specific entries, continue in the shared ones
+        randWeight -= appWeights->at(0);
     }
     else {
-        randWeight = m_rng.getFloat(anyReplacements->weights->at(0));
+        if (anyWeights->at(0) <= 0.0f) {
+            return {};
+        }
+        randWeight = rng.getFloat(anyWeights->at(0));
     }
 
-    for (auto i = 1; i < anyReplacements->weights->size(); i++) {
-        if (randWeight <= anyReplacements->weights->at(i)) {
-            return std::tuple(anyReplacements->resourcePaths->at(i - 1),
-                              anyReplacements->appNames->at(i - 1));
-        }
+    const auto& weights = *anyWeights;
+    if (const auto it = std::lower_bound(weights.begin() + 1, weights.end(), randWeight); it != weights.end()) {
+        return {anyReplacements.get(), static_cast<size_t>(it - weights.begin() - 1)};
     }
+
+    // nothing applies to this appearance
+    return {};
 }
 
-void InfiniteRandomizerFrameworkNative::OnSectorPostLoad(RED4ext::IScriptable *aContext, RED4ext::CStackFrame *aFrame, RED4ext::CString *aOut, int64_t a4) {
-    RED4ext::Handle<RED4ext::worldStreamingSector> sector;
-    RED4ext::GetParameter(aFrame, &sector);
-    aFrame->code++;
+ReplacementEntry InfiniteRandomizerFrameworkNative::DrawEntry(
+    const AppearanceReplacements &replacement,
+    const RED4ext::CName &appearance, FastRNG &rng, const SelectionPolicy &policy) {
 
-    if (!m_initialized)
-    {
-        return;
+    // an entry drawn by its configured weight is kept in proportion to the weight the policy gives it, which selects by
+    // the policy weights exactly while only looking at the drawn entries
+    const auto maxWeightFactor = policy.MaxWeightFactor();
+    for (auto attempt = 0; attempt < g_policyDrawAttempts; attempt++) {
+        const auto entry = DrawEntry(replacement, appearance, rng);
+        if (!entry.set) {
+            return {};
+        }
+
+        const auto weight = EntryWeight(*entry.set, entry.index);
+        if (rng.getFloat(weight * maxWeightFactor) < policy.WeightOf(*entry.set, entry.index, weight)) {
+            return entry;
+        }
     }
 
-    for (auto& nodes = GetNodes(sector); const auto& node : nodes)
-    {
-        if (node->GetNativeType()->IsA(m_rttis->GetType("worldMeshNode")))
-        {
-            const auto meshNode = Red::Cast<RED4ext::worldMeshNode>(node);
+    // most of the weight is excluded, same entries as the plain draw, appearance specific ones first, but the total
+    // of the policy weights is summed
+    const auto appIt = replacement.find(appearance);
+    const Replacements* sets[] = {
+        appIt != replacement.end() ? appIt->second.get() : nullptr,
+        replacement.at(g_anyAppearance).get(),
+    };
 
-             if (!m_replacements.contains(meshNode->mesh.path)) {
-                 continue;
-             }
-            
-            auto replacementValues = GetRandomEntry(meshNode->mesh.path, meshNode->meshAppearance);
-            meshNode->mesh = RED4ext::RaRef<RED4ext::CMesh>(replacementValues._Myfirst._Val);
-            meshNode->meshAppearance = replacementValues._Get_rest()._Myfirst._Val;
+    // the variety budget is read once for every category of both sets, not once per entry and pass
+    std::optional<VarietyBudget::Admissions> admissions;
+    if (policy.varietyBudget) {
+        std::vector<uint32_t> categoryIds;
+        for (const auto* set : sets) {
+            for (size_t i = 0; set && i < set->categoryIds->size(); i++) {
+                // entries of one category are contiguous, the last id settles most of them
+                const auto categoryId = (*set->categoryIds)[i];
+                if (!categoryIds.empty() && categoryIds.back() == categoryId) {
+                    continue;
+                }
+                if (std::ranges::find(categoryIds, categoryId) == categoryIds.end()) {
+                    categoryIds.push_back(categoryId);
+                }
+            }
         }
-        else if (node->GetNativeType()->IsA(m_rttis->GetType("worldInstancedMeshNode"))) {
-            const auto instancedMeshNode = Red::Cast<RED4ext::worldInstancedMeshNode>(node);
+        admissions = policy.varietyBudget->Snapshot(categoryIds);
+    }
 
-            if (!m_replacements.contains(instancedMeshNode->mesh.path)) {
-                continue;
-            }
+    const auto weightAt = [&policy, &admissions](const Replacements& set, const size_t i) {
+        return policy.WeightOf(set, i, EntryWeight(set, i), admissions ? &*admissions : nullptr);
+    };
 
-            auto replacementValues = GetRandomEntry(instancedMeshNode->mesh.path, instancedMeshNode->meshAppearance);
-            instancedMeshNode->mesh = RED4ext::RaRef<RED4ext::CMesh>(replacementValues._Myfirst._Val);
-            instancedMeshNode->meshAppearance = replacementValues._Get_rest()._Myfirst._Val;
+    float totalWeight = 0.0f;
+    for (const auto* set : sets) {
+        for (size_t i = 0; set && i < set->resourcePaths->size(); i++) {
+            totalWeight += weightAt(*set, i);
         }
-        else if (node->GetNativeType()->IsA(m_rttis->GetType("worldBendedMeshNode"))) {
-            const auto bendedMeshNode = Red::Cast<RED4ext::worldBendedMeshNode>(node);
+    }
+
+    // everything was excluded
+    if (totalWeight <= 0.0f) {
+        return {};
+    }
 
-            if (!m_replacements.contains(bendedMeshNode->mesh.path)) {
+    // selections on other threads can move the weights between both passes, a draw past the end takes the last entry
+    const auto randWeight = rng.getFloat(totalWeight);
+    float weightSum = 0.0f;
+    ReplacementEntry last;
+    for (const auto* set : sets) {
+        for (size_t i = 0; set && i < set->resourcePaths->size(); i++) {
+            const auto weight = weightAt(*set, i);
+            if (weight <= 0.0f) {
                 continue;
             }
+            weightSum += weight;
+            last = {set, i};
+            if (randWeight <= weightSum) {
+                return last;
+            }
+        }
+    }
+
+    return last;
+}
+
+bool InfiniteRandomizerFrameworkNative::ValidateEntry(const ReplacementEntry& entry) {
+    auto& state = (*entry.set->entryStates)[entry.index];
 
-            auto replacementValues = GetRandomEntry(bendedMeshNode->mesh.path, bendedMeshNode->meshAppearance);
-            bendedMeshNode->mesh = RED4ext::RaRef<RED4ext::CMesh>(replacementValues._Myfirst._Val);
-            bendedMeshNode->meshAppearance = replacementValues._Get_rest()._Myfirst._Val;
+    auto current = state.load(std::memory_order_relaxed);
+    if (current == EntryState::Unchecked) {
+        // threads racing on the same entry both ask the depot and store the same answer
+        current = m_depot->ResourceExists(entry.set->resourcePaths->at(entry.index)) ? EntryState::Valid : EntryState::Invalid;
+        state.store(current, std::memory_order_relaxed);
+        m_patchCounters.lazyValidations.fetch_add(1, std::memory_order_relaxed);
+        if (current == EntryState::Invalid) {
+            CutEntry(*entry.set, entry.index);
         }
-        else if (node->GetNativeType()->IsA(m_rttis->GetType("worldFoliageNode"))) {
-            const auto foliageMeshNode = Red::Cast<RED4ext::worldFoliageNode>(node);
+    }
+
+    return current == EntryState::Valid;
+}
+
+std::tuple<RED4ext::ResourcePath, RED4ext::CName>
+InfiniteRandomizerFrameworkNative::GetRandomEntry(
+    const AppearanceReplacements &replacement,
+    const RED4ext::CName &appearance, FastRNG &rng) {
 
-            if (!m_replacements.contains(foliageMeshNode->mesh.path)) {
+    const auto entry = DrawEntry(replacement, appearance, rng);
+
+    // nothing applies to this appearance, an empty path keeps the original resource
+    if (!entry.set) {
+        return std::tuple(RED4ext::ResourcePath(), RED4ext::CName());
+    }
+
+    return std::tuple(entry.set->resourcePaths->at(entry.index), entry.set->appNames->at(entry.index));
+}
+
+std::tuple<RED4ext::ResourcePath, RED4ext::CName>
+InfiniteRandomizerFrameworkNative::GetRandomEntry(
+    const AppearanceReplacements &replacement,
+    const RED4ext::CName &appearance, FastRNG &rng, const SelectionPolicy &policy) {
+
+    auto entry = policy.IsDefault()
+        ? DrawEntry(replacement, appearance, rng)
+        : DrawEntry(replacement, appearance, rng, policy);
+
+    // entries admitted unchecked are validated when first drawn, and the variety budget can fill up between drawing an
+    // entry and acquiring it. an invalid entry is cut from its set and the policy weighs both as 0 afterwards, so every
+    // redraw excludes the entry that just failed and the loop ends once an entry is selected or nothing is left
+    while (entry.set && ((policy.validateLazily && !ValidateEntry(entry)) || !policy.OnSelected(*entry.set, entry.index))) {
+        entry = DrawEntry(replacement, appearance, rng, policy);
+    }
+
+    if (!entry.set) {
+        return std::tuple(RED4ext::ResourcePath(), RED4ext::CName());
+    }
+
+    return std::tuple(entry.set->resourcePaths->at(entry.index), entry.set->appNames->at(entry.index));
+}
+
+FastRNG& InfiniteRandomizerFrameworkNative::ThreadRng() {
+    // streams are spread by the golden ratio and mixed by split, so neighbouring threads do not start on correlated states
+    thread_local FastRNG rng = FastRNG{m_rngSeed.load() + m_rngStreams.fetch_add(1) * 0x9e3779b9u}.split();
+    return rng;
+}
+
+void InfiniteRandomizerFrameworkNative::RegisterNodePatchers() {
+    m_nodePatchers.clear();
+
+    for (const auto& definition : g_nodePatcherDefinitions) {
+        auto* type = m_rttis->GetClass(definition.className);
+        if (!type) {
+            RedLogger::Warning(std::format("Node type {} does not exist, it will not be randomized.", definition.className));
+            continue;
+        }
+
+        const auto* resourceProperty = type->GetProperty(definition.resourceProperty);
+        if (!resourceProperty || resourceProperty->type->GetType() != RED4ext::ERTTIType::ResourceAsyncReference) {
+            RedLogger::Warning(std::format("Node type {} has no resource reference `{}`, it will not be randomized.", definition.className, definition.resourceProperty));
+            continue;
+        }
+
+        auto appearanceOffset = g_noAppearanceOffset;
+        if (definition.appearanceProperty) {
+            const auto* appearanceProperty = type->GetProperty(definition.appearanceProperty);
+            if (!appearanceProperty || appearanceProperty->type->GetType() != RED4ext::ERTTIType::Name) {
+                RedLogger::Warning(std::format("Node type {} has no appearance name `{}`, it will not be randomized.", definition.className, definition.appearanceProperty));
                 continue;
             }
+            appearanceOffset = appearanceProperty->valueOffset;
+        }
+
+        const NodePatcher patcher{type, resourceProperty->valueOffset, appearanceOffset, definition.kind};
+
+        // every derived class is registered up front so the hot loop needs a single lookup and no IsA walk,
+        // a registration for a more derived class wins over the one inherited from its base
+        RED4ext::DynArray<RED4ext::CClass*> derivedTypes;
+        m_rttis->GetClasses(type, derivedTypes);
+        derivedTypes.PushBack(type);
+
+        for (auto* derivedType : derivedTypes) {
+            auto [it, inserted] = m_nodePatchers.try_emplace(derivedType, patcher);
+            if (!inserted && type->IsA(it->second.type)) {
+                it->second = patcher;
+            }
+        }
+    }
+
+    RedLogger::Info(std::format("Registered node patchers for {} node types", m_nodePatchers.size()));
+}
+
+void InfiniteRandomizerFrameworkNative::GatherCandidate(const RED4ext::DynArray<RED4ext::Handle<RED4ext::worldNode>>& nodes,
+                                                        const uint32_t i, std::vector<SectorCandidate>& candidates) {
+    const auto* node = nodes[i].GetPtr();
+    if (!node) {
+        return;
+    }
+
+    const auto patcherIt = m_nodePatchers.find(node->GetNativeType());
+    if (patcherIt == m_nodePatchers.end()) {
+        return;
+    }
 
-            auto replacementValues = GetRandomEntry(foliageMeshNode->mesh.path, foliageMeshNode->meshAppearance);
-            foliageMeshNode->mesh = RED4ext::RaRef<RED4ext::CMesh>(replacementValues._Myfirst._Val);
-            foliageMeshNode->meshAppearance = replacementValues._Get_rest()._Myfirst._Val;
+    const auto& patcher = patcherIt->second;
+    const auto* instance = reinterpret_cast<const uint8_t*>(node);
+    const auto resourcePath = *reinterpret_cast<const RED4ext::ResourcePath*>(instance + patcher.resourceOffset);
+    const auto appearance = patcher.appearanceOffset == g_noAppearanceOffset
+        ? g_anyAppearance
+        : *reinterpret_cast<const RED4ext::CName*>(instance + patcher.appearanceOffset);
+
+    candidates.push_back({i, &patcher, resourcePath, appearance, nullptr});
+}
+
+void InfiniteRandomizerFrameworkNative::GatherCandidates(const RED4ext::DynArray<RED4ext::Handle<RED4ext::worldNode>>& nodes,
+                                                         const uint32_t begin, const uint32_t end,
+                                                         std::vector<SectorCandidate>& candidates) {
+    for (uint32_t i = begin; i < end; i++)
+    {
+        GatherCandidate(nodes, i, candidates);
+    }
+}
+
+void InfiniteRandomizerFrameworkNative::GatherCandidates(const RED4ext::DynArray<RED4ext::Handle<RED4ext::worldNode>>& nodes,
+                                                         const std::vector<uint32_t>& nodeIndices,
+                                                         std::vector<SectorCandidate>& candidates) {
+    for (const auto i : nodeIndices)
+    {
+        if (i < nodes.size) {
+            GatherCandidate(nodes, i, candidates);
         }
-        else if (node->GetNativeType()->IsA(m_rttis->GetType("worldTerrainMeshNode"))) {
-            const auto terrainMeshNode = Red::Cast<RED4ext::worldTerrainMeshNode>(node);
+    }
+}
+
+void InfiniteRandomizerFrameworkNative::CollectHits(const std::vector<SectorCandidate>& candidates,
+                                                    std::vector<uint32_t>& nodeIndices) {
+    for (const auto& candidate : candidates)
+    {
+        if (candidate.replacement) {
+            nodeIndices.push_back(candidate.nodeIndex);
+        }
+    }
+}
 
-            if (!m_replacements.contains(terrainMeshNode->meshRef.path)) {
+void InfiniteRandomizerFrameworkNative::ProbeCandidates(const ReplacementSnapshot& snapshot,
+                                                        std::vector<SectorCandidate>& candidates) {
+    // candidates are probed in groups, every stage issues the loads for the whole group before the next stage
+    // consumes them, so the cache misses of a group overlap instead of stalling one after another
+    uint32_t slots[g_probeGroupSize];
+    bool cached[g_probeGroupSize];
+    SectorLookupCache cache;
+    uint64_t cacheHits = 0;
+
+    for (size_t groupStart = 0; groupStart < candidates.size(); groupStart += g_probeGroupSize) {
+        const auto groupEnd = std::min(groupStart + g_probeGroupSize, candidates.size());
+
+        for (auto i = groupStart; i < groupEnd; i++) {
+            auto& candidate = candidates[i];
+            cached[i - groupStart] = cache.TryGet(candidate.resourcePathHash, candidate.replacement);
+            if (cached[i - groupStart]) {
+                cacheHits++;
                 continue;
             }
+            snapshot.index.PrefetchBucket(candidate.resourcePathHash);
+        }
 
-            auto replacementValues = GetRandomEntry(terrainMeshNode->meshRef.path, g_anyAppearance);
-            terrainMeshNode->meshRef = RED4ext::RaRef<RED4ext::CMesh>(replacementValues._Myfirst._Val);
+        for (auto i = groupStart; i < groupEnd; i++) {
+            if (cached[i - groupStart]) {
+                continue;
+            }
+            const auto slot = snapshot.index.Locate(candidates[i].resourcePathHash);
+            slots[i - groupStart] = slot;
+            if (slot != PerfectHashIndex::npos) {
+                snapshot.PrefetchSlot(slot);
+            }
         }
-        else if (node->GetNativeType()->IsA(m_rttis->GetType("worldEntityNode"))) {
-            const auto entityNode = Red::Cast<RED4ext::worldEntityNode>(node);
 
-            if (!m_replacements.contains(entityNode->entityTemplate.path)) {
+        for (auto i = groupStart; i < groupEnd; i++) {
+            if (cached[i - groupStart]) {
                 continue;
             }
+            auto& candidate = candidates[i];
+            const auto slot = slots[i - groupStart];
+            if (slot != PerfectHashIndex::npos && snapshot.index.Verify(slot, candidate.resourcePathHash)) {
+                candidate.replacement = &snapshot.slots[slot];
+            }
+            cache.Put(candidate.resourcePathHash, candidate.replacement);
+        }
+    }
+
+    m_patchCounters.lookups.fetch_add(candidates.size(), std::memory_order_relaxed);
+    m_patchCounters.lookupCacheHits.fetch_add(cacheHits, std::memory_order_relaxed);
+}
+
+void InfiniteRandomizerFrameworkNative::ApplyCandidates(const RED4ext::DynArray<RED4ext::Handle<RED4ext::worldNode>>& nodes,
+                                                        const std::vector<SectorCandidate>& candidates, FastRNG& rng,
+                                                        const SelectionPolicy& policy, std::vector<ChosenReplacement>& chosen) {
+    uint64_t replacedNodes = 0;
+    uint64_t pressureFallbacks = 0;
 
-            auto replacementValues = GetRandomEntry(entityNode->entityTemplate.path, entityNode->appearanceName);
-            entityNode->entityTemplate = RED4ext::RaRef<RED4ext::ent::EntityTemplate>(replacementValues._Myfirst._Val);
-            entityNode->appearanceName = replacementValues._Get_rest()._Myfirst._Val;
+    for (const auto& candidate : candidates)
+    {
+        if (!candidate.replacement) {
+            continue;
         }
-        else if (node->GetNativeType()->IsA(m_rttis->GetType("worldStaticDecalNode"))) {
-            const auto decalNode = Red::Cast<RED4ext::worldStaticDecalNode>(node);
 
-            if (!m_replacements.contains(decalNode->material.path)) {
-                continue;
+        // under memory pressure a node may keep the resource the engine streams for it anyway
+        if (const auto chance = policy.FallbackChance(candidate.patcher->kind); chance > 0.0f && rng.getFloat(1.0f) < chance) {
+            pressureFallbacks++;
+            continue;
+        }
+
+        const auto [resourcePath, appearance] = GetRandomEntry(*candidate.replacement, candidate.appearance, rng, policy);
+        if (resourcePath.IsEmpty()) {
+            continue;
+        }
+        chosen.push_back({resourcePath});
+
+        auto* instance = reinterpret_cast<uint8_t*>(nodes[candidate.nodeIndex].GetPtr());
+        *reinterpret_cast<RED4ext::ResourcePath*>(instance + candidate.patcher->resourceOffset) = resourcePath;
+        if (candidate.patcher->appearanceOffset != g_noAppearanceOffset) {
+            *reinterpret_cast<RED4ext::CName*>(instance + candidate.patcher->appearanceOffset) = appearance;
+        }
+        replacedNodes++;
+    }
+
+    m_patchCounters.replacedNodes.fetch_add(replacedNodes, std::memory_order_relaxed);
+    m_patchCounters.pressureFallbacks.fetch_add(pressureFallbacks, std::memory_order_relaxed);
+}
+
+void InfiniteRandomizerFrameworkNative::CollectResidentPaths(const std::vector<SectorCandidate>& candidates,
+                                                             std::vector<uint64_t>& residentPaths) {
+    thread_local std::vector<const AppearanceReplacements*> appMaps;
+    thread_local std::vector<const Replacements*> sets;
+    thread_local std::vector<uint64_t> resourcePaths;
+    appMaps.clear();
+    sets.clear();
+    resourcePaths.clear();
+
+    // candidates sharing a resource share its map and maps share sets, each distinct path is looked up once
+    for (const auto& candidate : candidates) {
+        if (candidate.replacement) {
+            appMaps.push_back(candidate.replacement);
+        }
+    }
+    std::ranges::sort(appMaps);
+    appMaps.erase(std::ranges::unique(appMaps).begin(), appMaps.end());
+
+    for (const auto* appMap : appMaps) {
+        for (const auto& set : *appMap | std::views::values) {
+            sets.push_back(set.get());
+        }
+    }
+    std::ranges::sort(sets);
+    sets.erase(std::ranges::unique(sets).begin(), sets.end());
+
+    for (const auto* set : sets) {
+        for (const auto resourcePath : *set->resourcePaths) {
+            resourcePaths.push_back(resourcePath);
+        }
+    }
+    std::ranges::sort(resourcePaths);
+    resourcePaths.erase(std::ranges::unique(resourcePaths).begin(), resourcePaths.end());
+
+    m_residencyCache.Collect(resourcePaths, residentPaths);
+}
+
+SelectionPolicy InfiniteRandomizerFrameworkNative::BuildSelectionPolicy(const ReplacementSnapshot& snapshot,
+                                                                        const std::vector<SectorCandidate>& candidates,
+                                                                        std::vector<uint64_t>& residentPaths,
+                                                                        std::vector<VarietyBudget::LiveVariant>& liveVariants) {
+    SelectionPolicy policy;
+    policy.validateLazily = snapshot.settings.validateResourcesLazily;
+
+    if (snapshot.settings.degradeUnderMemoryPressure) {
+        const auto pressure = m_memoryPressure.Current();
+        for (size_t kind = 0; kind < std::size(policy.fallbackChance); kind++) {
+            policy.fallbackChance[kind] = MemoryPressure::FallbackChance(pressure, snapshot.settings.memoryPressureThresholds[kind]);
+        }
+    }
+
+    if (snapshot.settings.categoryVarietyLimit > 0) {
+        policy.varietyBudget = &m_varietyBudget;
+        policy.liveVariants = &liveVariants;
+    }
+
+    if (snapshot.settings.preferResidentReplacements) {
+        residentPaths.clear();
+        CollectResidentPaths(candidates, residentPaths);
+        policy.residentPaths = &residentPaths;
+        policy.residentWeightBoost = snapshot.settings.residentWeightBoost;
+    }
+
+    return policy;
+}
+
+void InfiniteRandomizerFrameworkNative::TrackLiveVariants(const ReplacementSnapshot& snapshot, RED4ext::worldStreamingSector* sector,
+                                                          std::vector<VarietyBudget::LiveVariant> liveVariants) {
+    if (snapshot.settings.categoryVarietyLimit > 0) {
+        m_varietyBudget.Track(sector->ref, std::move(liveVariants));
+    }
+}
+
+void InfiniteRandomizerFrameworkNative::PatchNodesParallel(const ReplacementSnapshot& snapshot,
+                                                           const RED4ext::DynArray<RED4ext::Handle<RED4ext::worldNode>>& nodes,
+                                                           std::vector<uint32_t>& hitIndices,
+                                                           std::vector<ChosenReplacement>& chosen,
+                                                           std::vector<VarietyBudget::LiveVariant>& liveVariants) {
+    const uint32_t chunkCount = (nodes.size + g_parallelChunkSize - 1) / g_parallelChunkSize;
+
+    std::vector<std::vector<uint32_t>> chunkHits(chunkCount);
+    std::vector<std::vector<ChosenReplacement>> chunkChosen(chunkCount);
+    std::vector<std::vector<VarietyBudget::LiveVariant>> chunkVariants(chunkCount);
+
+    const auto patchChunk = [&snapshot, &nodes, &chunkHits, &chunkChosen, &chunkVariants](const size_t chunk) {
+        thread_local std::vector<SectorCandidate> candidates;
+        candidates.clear();
+
+        const auto begin = static_cast<uint32_t>(chunk) * g_parallelChunkSize;
+        const auto end = std::min(begin + g_parallelChunkSize, nodes.size);
+        GatherCandidates(nodes, begin, end, candidates);
+        ProbeCandidates(snapshot, candidates);
+        CollectHits(candidates, chunkHits[chunk]);
+
+        thread_local std::vector<uint64_t> residentPaths;
+        const auto policy = BuildSelectionPolicy(snapshot, candidates, residentPaths, chunkVariants[chunk]);
+        // a chunk runs on whichever thread claimed it and draws from that thread's stream
+        ApplyCandidates(nodes, candidates, ThreadRng(), policy, chunkChosen[chunk]);
+    };
+
+    ParallelJobs::Run(chunkCount, patchChunk);
+
+    for (const auto& hits : chunkHits) {
+        hitIndices.insert(hitIndices.end(), hits.begin(), hits.end());
+    }
+    for (const auto& chunk : chunkChosen) {
+        chosen.insert(chosen.end(), chunk.begin(), chunk.end());
+    }
+    for (const auto& chunk : chunkVariants) {
+        liveVariants.insert(liveVariants.end(), chunk.begin(), chunk.end());
+    }
+}
+
+void InfiniteRandomizerFrameworkNative::PrefetchReplacements(const std::vector<ChosenReplacement>& chosen) {
+    thread_local std::vector<uint64_t> resourcePaths;
+    resourcePaths.clear();
+
+    for (const auto& replacement : chosen) {
+        resourcePaths.push_back(replacement.resourcePath);
+    }
+
+    // a sector often picks the same replacement for many nodes, it is requested once
+    std::ranges::sort(resourcePaths);
+    const auto [first, last] = std::ranges::unique(resourcePaths);
+    resourcePaths.erase(first, last);
+
+    const auto issued = m_prefetcher.Request(resourcePaths);
+    m_patchCounters.prefetchRequests.fetch_add(issued, std::memory_order_relaxed);
+}
+
+InfiniteRandomizerFrameworkNative::DependencyScan
+InfiniteRandomizerFrameworkNative::ScanSectorDependencies(const ReplacementSnapshot& snapshot, const RED4ext::ResourcePath sectorPath,
+                                                          std::vector<uint64_t>& dependencyPaths) {
+    if (sectorPath.IsEmpty()) {
+        return DependencyScan::Unavailable;
+    }
+
+    const auto token = RED4ext::ResourceLoader::Get()->FindToken(sectorPath);
+    if (!token) {
+        return DependencyScan::Unavailable;
+    }
+
+    std::shared_lock lock(token->lock);
+    if (token->dependencies.size == 0) {
+        return DependencyScan::Unavailable;
+    }
+
+    auto result = DependencyScan::NoReplaceablePaths;
+    for (const auto& dependency : token->dependencies) {
+        if (!dependency) {
+            continue;
+        }
+
+        dependencyPaths.push_back(dependency->path);
+        if (snapshot.index.Find(dependency->path) != PerfectHashIndex::npos) {
+            result = DependencyScan::HasReplaceablePaths;
+        }
+    }
+
+    std::ranges::sort(dependencyPaths);
+    return result;
+}
+
+void InfiniteRandomizerFrameworkNative::VerifySectorDependencies(const std::vector<SectorCandidate>& candidates,
+                                                                 const std::vector<uint64_t>& dependencyPaths) {
+    // only sectors that actually replace something can confirm the list names the paths nodes reference
+    bool hasHits = false;
+
+    for (const auto& candidate : candidates) {
+        if (!candidate.replacement) {
+            continue;
+        }
+        hasHits = true;
+
+        if (!std::ranges::binary_search(dependencyPaths, candidate.resourcePathHash)) {
+            if (!m_dependencyListUnreliable.exchange(true)) {
+                RedLogger::Warning(std::format("Sector dependency lists do not name every node resource (missing {}), "
+                                               "sectors will always be scanned", candidate.resourcePathHash));
             }
+            return;
+        }
+    }
+
+    if (hasHits && m_dependencyListConfirmations.fetch_add(1) + 1 == g_dependencyListVerificationSectors) {
+        RedLogger::Info("Sector dependency lists verified, sectors without replaceable dependencies are skipped");
+    }
+}
+
+void InfiniteRandomizerFrameworkNative::OnSectorPostLoad(RED4ext::IScriptable *aContext, RED4ext::CStackFrame *aFrame, RED4ext::CString *aOut, int64_t a4) {
+    RED4ext::Handle<RED4ext::worldStreamingSector> sector;
+    RED4ext::GetParameter(aFrame, &sector);
+    aFrame->code++;
+
+    // sectors are already patched by the native post load hook, the script callback is only a fallback
+    if (m_nativePostLoadHooked || !sector)
+    {
+        return;
+    }
+
+    PatchSector(sector.GetPtr());
+}
+
+void InfiniteRandomizerFrameworkNative::PatchSector(RED4ext::worldStreamingSector* sector) {
+    if (!m_initialized)
+    {
+        return;
+    }
+
+    const auto snapshot = m_snapshot.load();
+    if (!snapshot)
+    {
+        return;
+    }
 
-            auto replacementValues = GetRandomEntry(decalNode->material.path, g_anyAppearance);
-            decalNode->material = RED4ext::RaRef<RED4ext::IMaterial>(replacementValues._Myfirst._Val);
+    const auto& nodes = GetNodes(sector);
+    const auto sectorPath = sector->path;
+    m_patchCounters.sectors.fetch_add(1, std::memory_order_relaxed);
+
+    // without the destructor hook unloaded sectors are only noticed by their expired handle, swept before selecting
+    if (snapshot->settings.categoryVarietyLimit > 0 && !m_sectorDestructorHooked) {
+        m_varietyBudget.ReleaseExpired();
+    }
+
+    // reused across sectors so the gather pass does not allocate once it has grown to the largest sector seen
+    thread_local std::vector<SectorCandidate> candidates;
+    thread_local std::vector<uint32_t> nodeIndices;
+    thread_local std::vector<ChosenReplacement> chosen;
+    thread_local std::vector<uint64_t> residentPaths;
+    std::vector<VarietyBudget::LiveVariant> liveVariants;
+    candidates.clear();
+    nodeIndices.clear();
+    chosen.clear();
+
+    // a sector seen before with the same replaceable paths only needs its recorded nodes, or nothing at all
+    if (!sectorPath.IsEmpty() && m_sectorManifest.TryGet(sectorPath, snapshot->keySetHash, snapshot->archiveFingerprint, nodes.size, nodeIndices))
+    {
+        if (nodeIndices.empty())
+        {
+            return;
+        }
+
+        GatherCandidates(nodes, nodeIndices, candidates);
+        ProbeCandidates(*snapshot, candidates);
+        ApplyCandidates(nodes, candidates, ThreadRng(), BuildSelectionPolicy(*snapshot, candidates, residentPaths, liveVariants), chosen);
+        TrackLiveVariants(*snapshot, sector, std::move(liveVariants));
+        if (snapshot->settings.prefetchReplacements)
+        {
+            PrefetchReplacements(chosen);
+        }
+        return;
+    }
+
+    // most sectors reference nothing replaceable, their dependency list tells without touching a single node
+    thread_local std::vector<uint64_t> dependencyPaths;
+    dependencyPaths.clear();
+    const auto dependencies = ScanSectorDependencies(*snapshot, sectorPath, dependencyPaths);
+    const auto dependencyListTrusted = !m_dependencyListUnreliable.load(std::memory_order_relaxed)
+        && m_dependencyListConfirmations.load(std::memory_order_relaxed) >= g_dependencyListVerificationSectors;
+
+    // the skip rests on a heuristic, it is not recorded in the manifest so a wrong guess does not outlive the session.
+    // the dependency list is checked again the next time the sector loads, which is about as cheap as the manifest
+    if (dependencies == DependencyScan::NoReplaceablePaths && dependencyListTrusted)
+    {
+        m_patchCounters.skippedSectors.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (nodes.size >= g_parallelSectorThreshold)
+    {
+        PatchNodesParallel(*snapshot, nodes, nodeIndices, chosen, liveVariants);
+    }
+    else
+    {
+        GatherCandidates(nodes, 0, nodes.size, candidates);
+        ProbeCandidates(*snapshot, candidates);
+        CollectHits(candidates, nodeIndices);
+        ApplyCandidates(nodes, candidates, ThreadRng(), BuildSelectionPolicy(*snapshot, candidates, residentPaths, liveVariants), chosen);
+
+        if (dependencies != DependencyScan::Unavailable && !dependencyListTrusted)
+        {
+            VerifySectorDependencies(candidates, dependencyPaths);
         }
     }
+
+    TrackLiveVariants(*snapshot, sector, std::move(liveVariants));
+
+    if (snapshot->settings.prefetchReplacements)
+    {
+        PrefetchReplacements(chosen);
+    }
+
+    if (!sectorPath.IsEmpty())
+    {
+        m_sectorManifest.Store(sectorPath, snapshot->keySetHash, snapshot->archiveFingerprint, nodes.size, nodeIndices);
+    }
 }
 }
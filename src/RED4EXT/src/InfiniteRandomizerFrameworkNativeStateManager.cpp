@@ -1,15 +1,19 @@
 #include "InfiniteRandomizerFrameworkNative.h"
 
+#include <algorithm>
 #include <fstream>
 #include <ranges>
 
 #include "RED4ext/Scripting/Utils.hpp"
 #include "Red4ext/Red4ext.hpp"
 #include "DataStructs/Globals.h"
+#include "DataStructs/CategorySet.h"
 #include <RedLib.hpp>
 #include <unordered_set>
 
 #include "RED4ext/ResourceDepot.hpp"
+#include "DataMerge.h"
+#include "DataParser.h"
 #include "RedLogger.h"
 #include <RapidJson/document.h>
 #include <RapidJson/error/en.h>
@@ -30,9 +34,28 @@ namespace InfiniteRandomizerFramework
         m_depot = RED4ext::ResourceDepot::Get();
         m_rttis = RED4ext::CRTTISystem::Get();
 
-        m_rng.state = std::chrono::system_clock::now().time_since_epoch().count();
+        m_rngSeed = static_cast<uint32_t>(std::chrono::system_clock::now().time_since_epoch().count());
+
+        RegisterNodePatchers();
+
+        if (m_sectorManifest.Load(GetSectorManifestPath())) {
+            RedLogger::Info(std::format("Loaded sector manifest with {} sectors", m_sectorManifest.Size()));
+        }
+
+        if (m_parseCache.Load(GetParseCachePath())) {
+            RedLogger::Info(std::format("Loaded parse cache with {} files", m_parseCache.Size()));
+        }
+        m_fileIndex.Load(GetFileIndexPath());
 
         LoadFromDiskInternal();
+        UpdateWatcher();
+
+        if (HookSectorPostLoad()) {
+            RedLogger::Info("Patching sectors from the native post load hook");
+        }
+        else {
+            RedLogger::Warning("Failed to hook sector post load, falling back to the script callback");
+        }
 
         m_initialized = true;
         RedLogger::Info("Initialized InfiniteRandomizerFramework Native");
@@ -42,137 +65,122 @@ namespace InfiniteRandomizerFramework
     {
         aFrame->code++;
         LoadFromDiskInternal();
+        UpdateWatcher();
     }
 
     void InfiniteRandomizerFrameworkNative::LoadFromDiskInternal()
     {
+        // the watcher reloads on its own thread, a reload from script waits for it
+        std::lock_guard lock(m_loadMutex);
         RedLogger::Info("Loading State From Disk...");
 
-        m_replacements.clear();
+        std::unordered_map<uint64_t, AppearanceReplacements> replacements;
 
-        auto categories = LoadCategoriesFromDisk();
-        auto variantPools = LoadVariantPoolsFromDisk();
+        auto settings = LoadSettingsFromDisk();
+        if (!m_poolStates.Load(GetPoolStatesPath())) {
+            RedLogger::Warning("Failed to load pool states, using the enabled state of the pool files.");
+        }
+        auto categories = LoadCategoriesFromDisk(settings.useFileIndex);
+        std::vector<PoolCatalogEntry> poolCatalog;
+        auto variantPools = LoadVariantPoolsFromDisk(settings.useFileIndex, &poolCatalog);
+        LoadBundlesFromDisk(categories, variantPools, &poolCatalog);
+        if (!settings.validateResourcesLazily) {
+            ValidateVariantPools(variantPools);
+        }
+
+        if (!m_parseCache.Save(GetParseCachePath())) {
+            RedLogger::Warning("Failed to save the parse cache.");
+        }
+        if (settings.useFileIndex && !m_fileIndex.Save(GetFileIndexPath())) {
+            RedLogger::Warning("Failed to save the file index.");
+        }
 
         RedLogger::Info(std::format("Parsed {} categories", categories.size()));
         RedLogger::Info(std::format("Parsed {} variant pools", variantPools.size()));
 
-        // string represents the xxhash64 as a list of all categories that the given replacement contains, separated via a _
-        std::unordered_map<std::string, std::shared_ptr<Replacements>> replacementMap;
-
         RedLogger::Info("Loading Variant Pools...");
 
-        for (const auto& pool : variantPools) {
-            if (!categories.contains(pool.second.category)) {
-                RedLogger::Error(std::format("Failed to load variant pool {}: target category {} does not exist.", pool.first, pool.second.category));
-                continue;
-            }
+        const auto resolved = DataMerge::ResolvePools(categories, variantPools);
+        const auto& categoryById = resolved.categoryById;
+        const auto& categoryNames = resolved.categoryNames;
+        const auto& categoryEntries = resolved.categoryEntries;
+        const auto& loadedPools = resolved.loadedPools;
 
-            Category& targetCat = categories.at(pool.second.category);
-            if (targetCat.extension != pool.second.extension) {
-                RedLogger::Error(std::format("Failed to load variant pool {}: target category {} type ({}), does not match variant pool type ({}).", pool.first, pool.second.category, targetCat.extension, pool.second.extension));
-                continue;
-            }
+        RedLogger::Info("Loading Categories...");
 
-            std::shared_ptr<Replacements> replacement;
-            auto catNameHash = XXHash64::hash(pool.second.category.data(), pool.second.category.size(), 0);
-            auto catNameHashStr = std::to_string(catNameHash);
-            if (replacementMap.contains(catNameHashStr)) {
-                replacement = replacementMap.at(catNameHashStr);
-            }
-            else {
-                replacement = std::make_shared<Replacements>();
-                replacement->weights = std::make_unique<std::vector<float>>();
-                replacement->appNames = std::make_unique<std::vector<RED4ext::CName>>();
-                replacement->resourcePaths = std::make_unique<std::vector<RED4ext::ResourcePath>>();
-                replacement->weights->push_back(0);
-            }
+        // every (resource, appearance) pair collects the set of categories it is part of
+        std::unordered_map<uint64_t, std::unordered_map<RED4ext::CName, CategorySet>> membership;
+        std::vector<size_t> categoryPairCounts(categoryById.size());
+        std::vector<size_t> categorySetUses(categoryById.size());
 
-            for (const auto& poolEntry : pool.second.entries) {
-                replacement->weights->at(0) += poolEntry.weight;
-                replacement->weights->push_back(poolEntry.weight);
-                replacement->appNames->push_back(RED4ext::CName(poolEntry.appearance.c_str()));
-                replacement->resourcePaths->push_back(poolEntry.resourcePath);
+        for (uint32_t catId = 0; catId < categoryById.size(); catId++) {
+            if (categoryEntries[catId].empty()) {
+                continue;
             }
 
-            if (!replacementMap.contains(catNameHashStr)) {
-                replacementMap.insert(std::make_pair(catNameHashStr, replacement));
+            for (const auto& catEntry : categoryById[catId]->entries) {
+                membership[catEntry.resourcePath.hash][catEntry.appearance].Add(catId);
             }
+            categoryPairCounts[catId] = categoryById[catId]->entries.size();
         }
 
-        RedLogger::Info("Loading Categories...");
-
-        std::unordered_map<uint64_t, std::unordered_map<RED4ext::CName, std::string>> addedCategories;
-
-        for (const auto& cat : categories) {
-            auto catNameHash = XXHash64::hash(cat.first.data(), cat.first.size(), 0);
-            auto catNameHashStr = std::to_string(catNameHash);
-
-            if (!replacementMap.contains(catNameHashStr)) {
-                continue;
-            }
+        // one combined distribution per distinct category set, shared by every pair with that set
+        std::unordered_map<CategorySet, std::shared_ptr<Replacements>, CategorySetHash> combinedReplacements;
+
+        for (auto& [resourcePathHash, appMap] : membership) {
+            auto& targetAppMap = replacements[resourcePathHash];
+            for (auto& [appearance, categorySet] : appMap) {
+                auto [combinedIt, inserted] = combinedReplacements.try_emplace(std::move(categorySet));
+                if (inserted) {
+                    size_t entryCount = 0;
+                    for (const auto catId : combinedIt->first.ids) {
+                        entryCount += categoryEntries[catId].size();
+                        categorySetUses[catId]++;
+                    }
 
-            for (const auto& catEntry : cat.second.entries) {
-                if (addedCategories.contains(catEntry.resourcePath.hash)) {
-                    auto& existingAppMap = addedCategories.at(catEntry.resourcePath.hash);
-                    if (existingAppMap.contains(catEntry.appearance)) {
-                        auto& existingCatName = existingAppMap.at(catEntry.appearance);
-                        auto& existingReplacement = replacementMap.at(existingCatName);
-                        existingCatName = std::format("{}_{}", existingCatName, catNameHashStr);
-
-                        auto newReplacement = std::make_shared<Replacements>();
-                        std::ranges::copy(*existingReplacement->weights, newReplacement->weights->begin());
-                        std::ranges::copy(*existingReplacement->appNames, newReplacement->appNames->begin());
-                        std::ranges::copy(*existingReplacement->resourcePaths, newReplacement->resourcePaths->begin());
-
-                        newReplacement->weights->insert(newReplacement->weights->end(), *existingReplacement->weights->begin() + 1);
-                        newReplacement->appNames->insert(newReplacement->appNames->end(), *existingReplacement->appNames->begin());
-                        newReplacement->resourcePaths->insert(newReplacement->resourcePaths->end(), *existingReplacement->resourcePaths->begin());
-
-                        newReplacement->weights->at(0) = 0.0f;
-                        for (const auto& weightEntry : *newReplacement->weights) {
-                            newReplacement->weights->at(0) += weightEntry;
+                    auto replacement = std::make_shared<Replacements>();
+                    replacement->weights = std::make_unique<std::vector<float>>();
+                    replacement->appNames = std::make_unique<std::vector<RED4ext::CName>>();
+                    replacement->resourcePaths = std::make_unique<std::vector<RED4ext::ResourcePath>>();
+                    replacement->categoryIds = std::make_unique<std::vector<uint32_t>>();
+                    replacement->weights->reserve(entryCount + 1);
+                    replacement->appNames->reserve(entryCount);
+                    replacement->resourcePaths->reserve(entryCount);
+                    replacement->categoryIds->reserve(entryCount);
+                    replacement->entryStates = std::make_unique<std::vector<std::atomic<EntryState>>>(entryCount);
+                    replacement->selections = std::make_unique<std::vector<std::atomic<uint32_t>>>(entryCount);
+                    replacement->weights->push_back(0);
+
+                    float weightSum = 0.0f;
+                    for (const auto catId : combinedIt->first.ids) {
+                        for (const auto* poolEntry : categoryEntries[catId]) {
+                            weightSum += poolEntry->weight;
+                            replacement->weights->push_back(weightSum);
+                            replacement->appNames->push_back(RED4ext::CName(poolEntry->appearance.c_str()));
+                            replacement->resourcePaths->push_back(poolEntry->resourcePath);
+                            replacement->categoryIds->push_back(catId);
                         }
-
-                        replacementMap.at(catNameHashStr) = std::move(newReplacement);
                     }
-                    else {
-                        existingAppMap[catEntry.appearance] = catNameHashStr;
+                    replacement->weights->at(0) = weightSum;
 
-                        m_replacements.at(catEntry.resourcePath.hash).insert({catEntry.appearance, replacementMap.at(catNameHashStr)});
-                    }
-                }
-                else {
-                    auto innerNameMap = std::unordered_map<RED4ext::CName, std::string>();
-                    innerNameMap.insert({catEntry.appearance, catNameHashStr});
-                    addedCategories.insert({catEntry.resourcePath.hash, innerNameMap});
-
-                    auto innerRepMap = std::unordered_map<RED4ext::CName, std::shared_ptr<Replacements>>();
-                    innerRepMap.insert({catEntry.appearance, replacementMap.at(catNameHashStr)});
-                    m_replacements.insert({catEntry.resourcePath.hash, innerRepMap});
+                    combinedIt->second = std::move(replacement);
                 }
+
+                targetAppMap.insert({appearance, combinedIt->second});
             }
         }
 
-        std::unordered_map<uint64_t, bool> processedSharedPtr;
-        for (auto &val : m_replacements | std::views::values) {
-            for (auto &valInner : val | std::views::values) {
-                if (processedSharedPtr.contains((uint64_t)valInner.get()))
-                    continue;
-
-                processedSharedPtr.insert({(uint64_t)valInner.get(), true});
-
-                if (valInner->weights->size() < 3)
-                    continue;
-
-                for (int i = 2; i < valInner->weights->size(); i++)
-                    valInner->weights->at(i) += valInner->weights->at(i - 1);
-            }
+        RedLogger::Info(std::format("Built {} distinct replacement sets", combinedReplacements.size()));
 
+        for (auto &val : replacements | std::views::values) {
             if (!val.contains(g_anyAppearance) && !val.empty()) {
                 auto anyRep = std::make_shared<Replacements>();
                 anyRep->weights = std::make_unique<std::vector<float>>();
                 anyRep->appNames = std::make_unique<std::vector<RED4ext::CName>>();
                 anyRep->resourcePaths = std::make_unique<std::vector<RED4ext::ResourcePath>>();
+                anyRep->categoryIds = std::make_unique<std::vector<uint32_t>>();
+                anyRep->entryStates = std::make_unique<std::vector<std::atomic<EntryState>>>();
+                anyRep->selections = std::make_unique<std::vector<std::atomic<uint32_t>>>();
 
                 anyRep->weights->push_back(0);
 
@@ -180,350 +188,495 @@ namespace InfiniteRandomizerFramework
             }
         }
 
-        for (auto it = m_replacements.begin(); it != m_replacements.end(); ) {
+        for (auto it = replacements.begin(); it != replacements.end(); ) {
             if (it->second.empty()) {
-                it = m_replacements.erase(it);
+                it = replacements.erase(it);
             } else {
                 ++it;
             }
         }
 
-        RedLogger::Info("Finished Loading");
-    }
-
-    std::filesystem::path GetExeDir() {
-        wchar_t buffer[MAX_PATH + 1];
-
-        DWORD len = GetModuleFileNameW(nullptr, buffer, MAX_PATH);
-        if (len == ERROR_INSUFFICIENT_BUFFER)
-            throw ERROR_INSUFFICIENT_BUFFER;
-
-        return std::filesystem::path(buffer).parent_path();
-    }
-
-    std::unordered_map<std::string, Category> InfiniteRandomizerFrameworkNative::LoadCategoriesFromDisk() {
-        std::string categoryDir;
-        try {
-            categoryDir = GetExeDir().string() + R"(\plugins\cyber_engine_tweaks\mods\InfiniteRandomizerFramework\data\categories)";
+        auto snapshot = std::make_shared<ReplacementSnapshot>();
+        snapshot->settings = settings;
+        snapshot->poolCatalog = std::move(poolCatalog);
+        std::vector<uint64_t> resourcePathHashes;
+        resourcePathHashes.reserve(replacements.size());
+        for (const auto& resourcePathHash : replacements | std::views::keys) {
+            resourcePathHashes.push_back(resourcePathHash);
         }
-        catch (const std::exception& e) {
-            RedLogger::Error(std::format("Failed to get executable directory. Cannot load Categories."));
-            return {};
+
+        if (!snapshot->index.Build(resourcePathHashes)) {
+            RedLogger::Error("Failed to build the replacement index, keeping the previously loaded state.");
+            return;
         }
 
-        auto parsedCategories = std::unordered_map<std::string, Category>();
+        std::ranges::sort(resourcePathHashes);
+        snapshot->keySetHash = XXHash64::hash(resourcePathHashes.data(), resourcePathHashes.size() * sizeof(uint64_t), 0);
+        snapshot->archiveFingerprint = ResourceValidationCache::ArchiveFingerprint(m_depot);
 
-        std::size_t count = std::distance(
-            fs::directory_iterator(categoryDir),
-            fs::directory_iterator{}
-        );
+        snapshot->slots.resize(snapshot->index.Size());
+        for (auto& [resourcePathHash, appMap] : replacements) {
+            snapshot->slots[snapshot->index.Find(resourcePathHash)] = std::move(appMap);
+        }
 
-        RedLogger::Info(std::format("Found {} category files", count));
+        RedLogger::Info(std::format("Indexed {} replaceable resources", snapshot->index.Size()));
 
-        try
-        {
-        for (const auto& categoryFile : fs::directory_iterator(categoryDir))
-        {
-            auto entryPath = categoryFile.path().string();
-            auto displayPath = categoryFile.path().filename().string();
-            if (!entryPath.ends_with(".json") || !categoryFile.is_regular_file())
-            {
+        constexpr size_t entryBytes = sizeof(float) + sizeof(RED4ext::CName) + sizeof(RED4ext::ResourcePath) + sizeof(uint32_t) + sizeof(EntryState);
+        constexpr size_t pairBytes = HashNodeBytes<RED4ext::CName, std::shared_ptr<Replacements>>();
+        for (uint32_t catId = 0; catId < categoryById.size(); catId++) {
+            if (categoryPairCounts[catId] == 0) {
                 continue;
             }
+            snapshot->categoryUsage.push_back({std::string(categoryNames[catId]), categoryPairCounts[catId] * pairBytes});
+        }
+        for (const auto& [poolName, catId] : loadedPools) {
+            const auto entryCount = variantPools.at(*poolName).entries.size();
+            snapshot->poolUsage.push_back({*poolName, entryCount * entryBytes * categorySetUses[catId]});
+        }
 
-            auto category = Category();
-            std::string name;
+        snapshot->loaderCaches.push_back({"Parse cache", m_parseCache.MemoryUsage()});
+        snapshot->loaderCaches.push_back({"File index", m_fileIndex.MemoryUsage()});
 
-            rapidjson::Document doc;
-            std::ifstream fileStream(entryPath);
-            std::stringstream buffer;
-            buffer << fileStream.rdbuf();
-            doc.Parse(buffer.str().c_str());
+        LogMemoryReport(MeasureMemory(*snapshot));
 
-            RedLogger::Info(std::format("Loading category {}", displayPath));
+        const auto prefetchReplacements = snapshot->settings.prefetchReplacements;
+        const auto categoryVarietyLimit = snapshot->settings.categoryVarietyLimit;
+        m_snapshot.store(std::move(snapshot));
+        // counters describe patching against the published state
+        m_patchCounters.Reset();
+        if (!prefetchReplacements) {
+            m_prefetcher.Clear();
+        }
+        // category ids are reassigned by every load
+        m_varietyBudget.Reset(categoryVarietyLimit);
 
-            if (doc.HasParseError()) {
-                RedLogger::Error(std::format("Failed to parse category file with error {}.", rapidjson::GetParseError_En(doc.GetParseError())));
-                continue;
-            }
+        SaveSectorManifest();
 
-            if (!doc.IsObject()) {
-                RedLogger::Error("Category file is malformed: root is not of type object.");
-                continue;
-            }
+        RedLogger::Info("Finished Loading");
+    }
 
-            if (!doc.HasMember("name")) {
-                RedLogger::Error("Category file is malformed: missing property `name`.");
-                continue;
-            }
+    void InfiniteRandomizerFrameworkNative::UpdateWatcher()
+    {
+        const auto snapshot = m_snapshot.load();
+        if (!snapshot || !snapshot->settings.watchForChanges) {
+            StopWatchingDataFiles();
+            return;
+        }
 
-            if (!doc["name"].IsString()) {
-                RedLogger::Error("Category file is malformed: property `name` is not of type string.");
-                continue;
-            }
+        if (m_dataWatcher.IsRunning()) {
+            return;
+        }
+        if (m_dataWatcher.Failed()) {
+            RedLogger::Warning("Watching for changes stopped after the change notifications failed, watching again.");
+        }
 
-            name = doc["name"].GetString();
+        std::vector directories = {GetModDir() / R"(data\categories)", GetModDir() / R"(data\variantPools)"};
+        std::error_code error;
+        if (fs::is_directory(GetBundleDir(), error)) {
+            directories.push_back(GetBundleDir());
+        }
+        if (m_dataWatcher.Start(directories, OnDataFilesChanged)) {
+            RedLogger::Info("Watching categories, variant pools and bundles for changes");
+        }
+        else {
+            RedLogger::Warning("Failed to watch categories and variant pools for changes.");
+        }
+    }
 
-            if (!doc.HasMember("entries")) {
-                RedLogger::Error("Category file is malformed: missing property `entries`.");
-                continue;
-            }
+    bool InfiniteRandomizerFrameworkNative::OnDataFilesChanged()
+    {
+        RedLogger::Info("Categories or variant pools changed, reloading...");
+        // only changed files are parsed again, the new state is published like any other reload
+        LoadFromDiskInternal();
 
-            if (!doc["entries"].IsArray()) {
-                RedLogger::Error("Category file is malformed: property `entries` is not of type array.");
-                continue;
-            }
+        const auto snapshot = m_snapshot.load();
+        return snapshot && snapshot->settings.watchForChanges;
+    }
 
-            auto entries = doc["entries"].GetArray();
-            auto i = -1;
-            for (const auto& entry : entries) {
-                i++;
-                if (!entry.IsObject()) {
-                    RedLogger::Warning(std::format("Category entry at {} is malformed: root is not of type object.", i));
-                    continue;
-                }
+    void InfiniteRandomizerFrameworkNative::StopWatchingDataFiles()
+    {
+        m_dataWatcher.Stop();
+    }
 
-                if (!entry.HasMember("resourcePath")) {
-                    RedLogger::Warning(std::format("Category entry at {} is malformed: missing property `resourcePath`.", i));
-                    continue;
-                }
+    void InfiniteRandomizerFrameworkNative::SaveSectorManifest()
+    {
+        if (!m_sectorManifest.Save(GetSectorManifestPath())) {
+            RedLogger::Warning("Failed to save the sector manifest.");
+        }
+    }
 
-                if (!entry["resourcePath"].IsString()) {
-                    RedLogger::Warning(std::format("Category entry at {} is malformed: property `resourcePath` is not of type string.", i));
-                    continue;
-                }
+    std::filesystem::path GetExeDir() {
+        wchar_t buffer[MAX_PATH + 1];
 
-                const auto resourcePathString = entry["resourcePath"].GetString();
-                const auto redResourcePath = RED4ext::ResourcePath(resourcePathString);
-                const auto extension = fs::path(resourcePathString).extension().string();
+        DWORD len = GetModuleFileNameW(nullptr, buffer, MAX_PATH);
+        if (len == ERROR_INSUFFICIENT_BUFFER)
+            throw ERROR_INSUFFICIENT_BUFFER;
 
-                if (category.extension.empty()) {
-                    category.extension = extension;
-                }
+        return std::filesystem::path(buffer).parent_path();
+    }
 
-                if (category.extension != extension) {
-                    RedLogger::Error("Category file is malformed: entries contains mixed resource types");
-                    goto breakCatLoop;
-                }
+    const std::filesystem::path& InfiniteRandomizerFrameworkNative::GetModDir() {
+        static const auto modDir = GetExeDir() / R"(plugins\cyber_engine_tweaks\mods\InfiniteRandomizerFramework)";
+        return modDir;
+    }
 
-                auto catEntry = CategoryEntry();
-                catEntry.resourcePath = redResourcePath;
+    std::filesystem::path InfiniteRandomizerFrameworkNative::GetSectorManifestPath() {
+        return GetModDir() / R"(cache\sectorManifest.bin)";
+    }
 
-                if (entry.HasMember("appearance")) {
-                    if (entry["appearance"].IsString()) {
-                        catEntry.appearance = entry["appearance"].GetString();
-                    }
-                    else {
-                        RedLogger::Warning(std::format("Category entry at {} is malformed: property `appearance` is not of type string, using default.", i));
-                        catEntry.appearance = g_anyAppearance;
-                    }
-                }
-                else {
-                    catEntry.appearance = g_anyAppearance;
-                }
+    std::string InfiniteRandomizerFrameworkNative::GetModRelativePath(const std::filesystem::path& path) {
+        return path.lexically_relative(GetModDir()).generic_string();
+    }
 
-                category.entries.push_back(catEntry);
-            }
+    void InfiniteRandomizerFrameworkNative::GetPoolCatalog(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame, RED4ext::CString* aOut, int64_t a4)
+    {
+        aFrame->code++;
 
-            if (parsedCategories.contains(name)) {
-                RedLogger::Error("Failed to load category: category with conflicting name exists.");
-            }
-            else {
-                parsedCategories[name] = category;
+        RED4ext::DynArray<RED4ext::CString> catalog;
+        if (const auto snapshot = m_snapshot.load()) {
+            catalog.Reserve(static_cast<uint32_t>(snapshot->poolCatalog.size() * g_poolCatalogStride));
+            for (const auto& pool : snapshot->poolCatalog) {
+                catalog.EmplaceBack(pool.name.c_str());
+                catalog.EmplaceBack(pool.category.c_str());
+                catalog.EmplaceBack(pool.enabled ? "true" : "false");
+                catalog.EmplaceBack(std::to_string(pool.variantCount).c_str());
+                catalog.EmplaceBack(pool.filePath.c_str());
             }
-            breakCatLoop:
-                ;
         }
+
+        if (aOut) {
+            *reinterpret_cast<RED4ext::DynArray<RED4ext::CString>*>(aOut) = std::move(catalog);
         }
-        catch (const std::exception &e)
+    }
+
+    std::filesystem::path InfiniteRandomizerFrameworkNative::GetParseCachePath() {
+        return GetModDir() / R"(cache\parseCache.bin)";
+    }
+
+    std::filesystem::path InfiniteRandomizerFrameworkNative::GetFileIndexPath() {
+        return GetModDir() / R"(cache\fileIndex.bin)";
+    }
+
+    std::filesystem::path InfiniteRandomizerFrameworkNative::GetPoolStatesPath() {
+        return GetModDir() / R"(data\poolStates.json)";
+    }
+
+    void InfiniteRandomizerFrameworkNative::SetPoolEnabled(RED4ext::IScriptable* aContext, RED4ext::CStackFrame* aFrame, RED4ext::CString* aOut, int64_t a4)
+    {
+        RED4ext::CString name;
+        bool enabled;
+        RED4ext::GetParameter(aFrame, &name);
+        RED4ext::GetParameter(aFrame, &enabled);
+        aFrame->code++;
+
+        bool saved;
         {
-        RedLogger::Error(std::format("Failed to load Categories from disk with error: {}", e.what()));
-        return {};
+            // the overlay is re-read by every load, the change has to be on disk before the reload below
+            std::lock_guard lock(m_loadMutex);
+            m_poolStates.Set(name.c_str(), enabled);
+            saved = m_poolStates.Save(GetPoolStatesPath());
+        }
+
+        if (saved) {
+            RedLogger::Info(std::format("Variant pool {} {}.", name.c_str(), enabled ? "enabled" : "disabled"));
+            LoadFromDiskInternal();
+        }
+        else {
+            RedLogger::Error(std::format("Failed to save the state of variant pool {}.", name.c_str()));
+        }
+
+        if (aOut) {
+            *reinterpret_cast<bool*>(aOut) = saved;
         }
-        return parsedCategories;
     }
 
-    std::unordered_map<std::string, VariantPool> InfiniteRandomizerFrameworkNative::LoadVariantPoolsFromDisk() {
-        std::string variantPoolDir;
+    Settings InfiniteRandomizerFrameworkNative::LoadSettingsFromDisk() {
+        Settings settings;
+
+        std::ifstream fileStream;
         try {
-            variantPoolDir = GetExeDir().string() + R"(\plugins\cyber_engine_tweaks\mods\InfiniteRandomizerFramework\data\variantPools)";
+            fileStream.open(GetModDir() / R"(data\settings.json)");
         }
         catch (const std::exception& e) {
-            RedLogger::Error(std::format("Failed to get executable directory. Cannot load Variant Pools."));
-            return {};
+            RedLogger::Error("Failed to get executable directory. Using default settings.");
+            return settings;
         }
 
-        std::unordered_map<std::string, VariantPool> parsedPools;
+        if (!fileStream) {
+            RedLogger::Info("No settings file found, using default settings.");
+            return settings;
+        }
 
-        std::size_t count = std::distance(
-        fs::directory_iterator(variantPoolDir),
-        fs::directory_iterator{}
-        );
+        rapidjson::Document doc;
+        std::stringstream buffer;
+        buffer << fileStream.rdbuf();
+        doc.Parse(buffer.str().c_str());
 
-        RedLogger::Info(std::format("Found {} variant pool files", count));
+        if (doc.HasParseError()) {
+            RedLogger::Error(std::format("Failed to parse settings file with error {}, using default settings.", rapidjson::GetParseError_En(doc.GetParseError())));
+            return settings;
+        }
 
-        try
-        {
-        for (const auto& poolFile : fs::directory_iterator(variantPoolDir)) {
-            auto entryPath = poolFile.path().string();
-            auto displayPath = poolFile.path().filename().string();
-            if (!entryPath.ends_with(".json") || !poolFile.is_regular_file())
-            {
-                continue;
+        if (!doc.IsObject()) {
+            RedLogger::Error("Settings file is malformed: root is not of type object, using default settings.");
+            return settings;
+        }
+
+        const auto readBool = [&doc](const char* name, bool& value) {
+            if (!doc.HasMember(name)) {
+                return;
+            }
+            if (!doc[name].IsBool()) {
+                RedLogger::Warning(std::format("Settings file is malformed: property `{}` is not of type bool, using default.", name));
+                return;
             }
+            value = doc[name].GetBool();
+        };
 
-            auto pool = VariantPool();
-            std::string name;
+        const auto readFloat = [&doc](const char* name, float& value, const float min) {
+            if (!doc.HasMember(name)) {
+                return;
+            }
+            if (!doc[name].IsNumber()) {
+                RedLogger::Warning(std::format("Settings file is malformed: property `{}` is not of type number, using default.", name));
+                return;
+            }
+            if (doc[name].GetFloat() < min) {
+                RedLogger::Warning(std::format("Settings file is malformed: property `{}` must be at least {}, using default.", name, min));
+                return;
+            }
+            value = doc[name].GetFloat();
+        };
 
-            rapidjson::Document doc;
-            std::ifstream fileStream(entryPath);
-            std::stringstream buffer;
-            buffer << fileStream.rdbuf();
-            doc.Parse(buffer.str().c_str());
+        const auto readUint = [&doc](const char* name, uint32_t& value) {
+            if (!doc.HasMember(name)) {
+                return;
+            }
+            if (!doc[name].IsUint()) {
+                RedLogger::Warning(std::format("Settings file is malformed: property `{}` is not a non negative integer, using default.", name));
+                return;
+            }
+            value = doc[name].GetUint();
+        };
 
-            RedLogger::Info(std::format("Loading variant pool {}", displayPath));
+        readBool("prefetchReplacements", settings.prefetchReplacements);
+        readBool("preferResidentReplacements", settings.preferResidentReplacements);
+        readFloat("residentWeightBoost", settings.residentWeightBoost, 1.0f);
+        readUint("categoryVarietyLimit", settings.categoryVarietyLimit);
+        readBool("validateResourcesLazily", settings.validateResourcesLazily);
+        readBool("degradeUnderMemoryPressure", settings.degradeUnderMemoryPressure);
+        readBool("watchForChanges", settings.watchForChanges);
+        readBool("useFileIndex", settings.useFileIndex);
 
-            if (doc.HasParseError()) {
-                RedLogger::Error(std::format("Failed to parse variant pool file with error {}.", rapidjson::GetParseError_En(doc.GetParseError())));
-                continue;
+        if (doc.HasMember("memoryPressureThresholds")) {
+            const auto& thresholds = doc["memoryPressureThresholds"];
+            if (!thresholds.IsObject()) {
+                RedLogger::Warning("Settings file is malformed: property `memoryPressureThresholds` is not of type object, using defaults.");
             }
-
-            if (!doc.IsObject()) {
-                RedLogger::Error("Variant pool file is malformed: root is not of type object.");
-                continue;
+            else {
+                constexpr std::pair<const char*, ResourceKind> kinds[] = {
+                    {"mesh", ResourceKind::Mesh},
+                    {"ent", ResourceKind::Entity},
+                    {"mi", ResourceKind::Material},
+                };
+                for (const auto& [extension, kind] : kinds) {
+                    if (!thresholds.HasMember(extension)) {
+                        continue;
+                    }
+                    if (!thresholds[extension].IsNumber() || thresholds[extension].GetFloat() < 0.0f || thresholds[extension].GetFloat() > 1.0f) {
+                        RedLogger::Warning(std::format("Settings file is malformed: memory pressure threshold `{}` is not a number between 0 and 1, using default.", extension));
+                        continue;
+                    }
+                    settings.memoryPressureThresholds[static_cast<size_t>(kind)] = thresholds[extension].GetFloat();
+                }
             }
+        }
 
-            if (!doc.HasMember("enabled")) {
-                RedLogger::Error("Variant pool file is malformed: missing property `enabled`.");
-                continue;
-            }
+        RedLogger::Info(std::format("Loaded settings: prefetchReplacements {}, preferResidentReplacements {} (boost {}), categoryVarietyLimit {}, degradeUnderMemoryPressure {}, validateResourcesLazily {}, watchForChanges {}, useFileIndex {}",
+            settings.prefetchReplacements, settings.preferResidentReplacements, settings.residentWeightBoost, settings.categoryVarietyLimit,
+            settings.degradeUnderMemoryPressure, settings.validateResourcesLazily, settings.watchForChanges, settings.useFileIndex));
+        return settings;
+    }
 
-            if (!doc["enabled"].IsBool()) {
-                RedLogger::Error("Variant pool file is malformed: property `enabled` is not of type bool.");
-                continue;
-            }
+    namespace {
+    // returns the parsed form of the file, it is only read when its size or write time changed
+    // and only parsed again when its content hash changed as well. null if the file could not be read or was rejected,
+    // neither is cached
+    template<typename T, typename Parse>
+    const ParseCache::File<T>* LoadFileCached(ParseCache& cache, ParseCache::Files<T>& files, const fs::directory_entry& file,
+                                              Parse parse, size_t& reusedCount) {
+        auto entryPath = file.path().string();
+        const auto size = static_cast<uint64_t>(file.file_size());
+        const auto writeTime = static_cast<int64_t>(file.last_write_time().time_since_epoch().count());
+
+        auto it = files.find(entryPath);
+        if (it != files.end() && it->second.fingerprint.size == size && it->second.fingerprint.writeTime == writeTime) {
+            reusedCount++;
+            return &it->second;
+        }
 
-            if (!doc["enabled"].GetBool()) {
-                RedLogger::Info("Variant pool is disabled.");
-                continue;
-            }
+        std::ifstream fileStream(file.path(), std::ios::binary);
+        std::stringstream buffer;
+        buffer << fileStream.rdbuf();
+        const auto content = buffer.str();
 
-            if (!doc.HasMember("name")) {
-                RedLogger::Error("Variant pool file is malformed: missing property `name`.");
-                continue;
-            }
+        // a short read would be hashed and parsed as if it were the file, it is tried again on the next load instead
+        if (!fileStream || content.size() != size) {
+            RedLogger::Error(std::format("Failed to read {}, it will be read again on the next load.", file.path().filename().string()));
+            return nullptr;
+        }
+        const auto contentHash = XXHash64::hash(content.data(), content.size(), 0);
+
+        cache.MarkDirty();
+        if (it != files.end() && it->second.fingerprint.size == size && it->second.fingerprint.contentHash == contentHash) {
+            // touched but unchanged
+            it->second.fingerprint.writeTime = writeTime;
+            reusedCount++;
+            return &it->second;
+        }
 
-            if (!doc["name"].IsString()) {
-                RedLogger::Error("Variant pool file is malformed: property `name` is not of type string.");
-                continue;
+        ParseCache::File<T> parsed{};
+        parsed.fingerprint = {size, writeTime, contentHash};
+        if (!parse(file.path().filename().string(), content, parsed.name, parsed.value)) {
+            if (it != files.end()) {
+                files.erase(it);
             }
+            return nullptr;
+        }
+        return &files.insert_or_assign(std::move(entryPath), std::move(parsed)).first->second;
+    }
 
-            name = doc["name"].GetString();
+    // drops files that were deleted since they were cached
+    template<typename T>
+    void PruneFiles(ParseCache& cache, ParseCache::Files<T>& files, const std::unordered_set<std::string>& seenPaths) {
+        if (std::erase_if(files, [&seenPaths](const auto& file) { return !seenPaths.contains(file.first); }) > 0) {
+            cache.MarkDirty();
+        }
+    }
+    }
 
-            if (!doc.HasMember("category")) {
-                RedLogger::Error("Variant pool file is malformed: missing property `category`.");
-                continue;
+    std::vector<fs::directory_entry> InfiniteRandomizerFrameworkNative::DiscoverDataFiles(const fs::path& directory, const bool useFileIndex) {
+        std::vector<fs::directory_entry> files;
+        const auto writeTime = static_cast<int64_t>(fs::last_write_time(directory).time_since_epoch().count());
+
+        std::vector<std::string> names;
+        if (useFileIndex && m_fileIndex.TryGet(directory, writeTime, names)) {
+            // building the entry of a listed file is the one metadata query the parse cache needs to tell whether the
+            // file changed, only a file that is gone costs the enumeration
+            auto complete = true;
+            files.reserve(names.size());
+            for (const auto& name : names) {
+                std::error_code error;
+                fs::directory_entry file(directory / name, error);
+                if (error || !file.is_regular_file(error)) {
+                    RedLogger::Warning(std::format("{} vanished without changing the write time of its directory, it is enumerated from now on.",
+                        name));
+                    m_fileIndex.MarkUnreliable(directory);
+                    complete = false;
+                    break;
+                }
+                files.push_back(std::move(file));
             }
+            if (complete) {
+                return files;
+            }
+            files.clear();
+            names.clear();
+        }
 
-            if (!doc["category"].IsString()) {
-                RedLogger::Error("Variant pool files is malformed: property `category` is not of type string.");
-                continue;
+        // a single pass, the entries already carry the size and write time the parse cache compares
+        for (const auto& file : fs::directory_iterator(directory)) {
+            if (file.path().extension() == ".json" && file.is_regular_file()) {
+                files.push_back(file);
+                names.push_back(file.path().filename().string());
             }
+        }
 
-            pool.category = doc["category"].GetString();
+        if (useFileIndex) {
+            m_fileIndex.Store(directory, writeTime, std::move(names));
+        }
+        return files;
+    }
 
-            if (!doc.HasMember("variants")) {
-                RedLogger::Error("Variant pool file is malformed: missing property `variants`.");
-                continue;
-            }
+    std::unordered_map<std::string, Category> InfiniteRandomizerFrameworkNative::LoadCategoriesFromDisk(const bool useFileIndex) {
+        auto parsedCategories = std::unordered_map<std::string, Category>();
+
+        auto& cachedFiles = m_parseCache.Categories();
+        std::unordered_set<std::string> seenPaths;
+        size_t reusedCount = 0;
+
+        try
+        {
+        const auto categoryFiles = DiscoverDataFiles(GetModDir() / R"(data\categories)", useFileIndex);
+        RedLogger::Info(std::format("Found {} category files", categoryFiles.size()));
 
-            if (!doc["variants"].IsArray()) {
-                RedLogger::Error("Variant pool file is malformed: property `variants` is not of type array.");
+        for (const auto& categoryFile : categoryFiles)
+        {
+            seenPaths.insert(categoryFile.path().string());
+            const auto* cachedFile = LoadFileCached(m_parseCache, cachedFiles, categoryFile, DataParser::ParseCategory, reusedCount);
+            if (!cachedFile) {
                 continue;
             }
+            const auto& cached = *cachedFile;
 
-            auto variantArray = doc["variants"].GetArray();
-            auto i = -1;
-            for (const auto& entry : variantArray) {
-                i++;
-                if (!entry.IsObject()) {
-                    RedLogger::Error(std::format("Variant pool entry at {} is malformed: root is not of type object.", i));
-                    continue;
-                }
-
-                if (!entry.HasMember("resourcePath")) {
-                    RedLogger::Error(std::format("Variant pool entry at {} is malformed: missing property `resourcePath`.", i));
-                    continue;
-                }
+            if (parsedCategories.contains(cached.name)) {
+                RedLogger::Error("Failed to load category: category with conflicting name exists.");
+            }
+            else {
+                parsedCategories[cached.name] = cached.value;
+            }
+        }
+        }
+        catch (const std::exception &e)
+        {
+        RedLogger::Error(std::format("Failed to load Categories from disk with error: {}", e.what()));
+        return {};
+        }
 
-                if (!entry["resourcePath"].IsString()) {
-                    RedLogger::Error(std::format("Variant pool entry at {} is malformed: property `resourcePath` is not of type string.", i));
-                    continue;
-                }
+        PruneFiles(m_parseCache, cachedFiles, seenPaths);
+        RedLogger::Info(std::format("Reused {} unchanged category files", reusedCount));
+        return parsedCategories;
+    }
 
-                const auto resourcePathString = entry["resourcePath"].GetString();
-                const auto redResourcePath = RED4ext::ResourcePath(resourcePathString);
-                if (!m_depot->ResourceExists(redResourcePath)) {
-                    RedLogger::Error(std::format("Variant pool entry at {} is invalid: property `resourcePath` does not point to a valid resource.", i));
-                    continue;
-                }
-                const auto extension = fs::path(resourcePathString).extension().string();
+    std::unordered_map<std::string, VariantPool> InfiniteRandomizerFrameworkNative::LoadVariantPoolsFromDisk(const bool useFileIndex,
+                                                                                                            std::vector<PoolCatalogEntry>* catalog) {
+        std::unordered_map<std::string, VariantPool> parsedPools;
 
-                if (pool.extension.empty()) {
-                    pool.extension = extension;
-                }
+        auto& cachedFiles = m_parseCache.VariantPools();
+        std::unordered_set<std::string> seenPaths;
+        size_t reusedCount = 0;
 
-                if (pool.extension != extension) {
-                    RedLogger::Error("Category file is malformed: entries contains mixed resource types");
-                    goto breakPoolLoop;
-                }
+        try
+        {
+        const auto poolFiles = DiscoverDataFiles(GetModDir() / R"(data\variantPools)", useFileIndex);
+        RedLogger::Info(std::format("Found {} variant pool files", poolFiles.size()));
 
-                auto variant = VariantPoolEntry();
-                variant.resourcePath = redResourcePath;
+        for (const auto& poolFile : poolFiles) {
+            seenPaths.insert(poolFile.path().string());
+            const auto* cachedFile = LoadFileCached(m_parseCache, cachedFiles, poolFile, DataParser::ParseVariantPool, reusedCount);
+            if (!cachedFile) {
+                continue;
+            }
+            const auto& cached = *cachedFile;
 
-                if (entry.HasMember("weight")) {
-                    if (entry["weight"].IsNumber()) {
-                        auto weight = entry["weight"].GetFloat();
-                        if (weight <= 0.0f) {
-                            RedLogger::Warning(std::format("Variant pool entry at {} is malformed: property `weight` must be bigger than 0, using default.", i));
-                            variant.weight = 1.0f;
-                        }
-                        else {
-                            variant.weight = weight;
-                        }
-                    }
-                    else {
-                        RedLogger::Warning(std::format("Variant pool entry at {} is malformed: property `weight` is not of type number, using default.", i));
-                        variant.weight = 1.0f;
-                    }
-                }
-                else {
-                    variant.weight = 1.0f;
-                }
+            const bool enabled = m_poolStates.IsEnabled(cached.name, cached.value.enabled);
+            if (catalog) {
+                catalog->push_back({cached.name, cached.value.category, enabled,
+                                    static_cast<uint32_t>(cached.value.entries.size()), GetModRelativePath(poolFile.path())});
+            }
 
-                if (entry.HasMember("appearance")) {
-                    if (entry["appearance"].IsString()) {
-                        variant.appearance = entry["appearance"].GetString();
-                    }
-                    else {
-                        RedLogger::Warning(std::format("Variant pool entry at {} is malformed: property `appearance` is not of type string, using default.", i));
-                        variant.appearance = "default";
-                    }
-                }
-                else {
-                    variant.appearance = "default";
-                }
-                pool.entries.push_back(variant);
+            if (!enabled) {
+                RedLogger::Info(std::format("Variant pool {} is disabled.", cached.name));
+                continue;
             }
 
-            if (parsedPools.contains(name)) {
+            if (parsedPools.contains(cached.name)) {
                 RedLogger::Error("Failed to load variant pool: variant pool with conflicting name exists.");
             }
             else {
-                parsedPools[name] = pool;
+                auto& pool = parsedPools[cached.name] = cached.value;
+                pool.enabled = true;
             }
-            breakPoolLoop:
-                ;
         }
         }
         catch (const std::exception &e)
@@ -531,7 +684,34 @@ namespace InfiniteRandomizerFramework
         RedLogger::Error(std::format("Failed to load Variant Pools from disk with error: {}", e.what()));
         return {};
         }
+
+        PruneFiles(m_parseCache, cachedFiles, seenPaths);
+        RedLogger::Info(std::format("Reused {} unchanged variant pool files", reusedCount));
         return parsedPools;
     }
 
+    void InfiniteRandomizerFrameworkNative::ValidateVariantPools(std::unordered_map<std::string, VariantPool>& pools) {
+        std::vector<uint64_t> resourcePaths;
+        for (const auto& pool : pools | std::views::values) {
+            for (const auto& entry : pool.entries) {
+                resourcePaths.push_back(entry.resourcePath);
+            }
+        }
+
+        const auto queried = m_validationCache.Validate(m_depot, resourcePaths);
+        RedLogger::Info(std::format("Validated {} variant resources, {} were not cached", resourcePaths.size(), queried));
+
+        for (auto& [name, pool] : pools) {
+            const auto entryCount = pool.entries.size();
+            std::erase_if(pool.entries, [](const VariantPoolEntry& entry) {
+                return !m_validationCache.Exists(entry.resourcePath);
+            });
+
+            if (pool.entries.size() != entryCount) {
+                RedLogger::Error(std::format("Variant pool {}: {} of {} variants do not point to a valid resource and were skipped.",
+                    name, entryCount - pool.entries.size(), entryCount));
+            }
+        }
+    }
+
 }
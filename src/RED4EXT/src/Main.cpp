@@ -47,6 +47,44 @@ namespace InfiniteRandomizerFramework
             &InfiniteRandomizerFrameworkNative::LoadFromDisk, {.isNative = true, .isStatic = true});
 
         customControllerClass.RegisterFunction(loadFromDisk);
+
+        const auto isNativePostLoadActive =
+            RED4ext::CClassStaticFunction::Create(&customControllerClass, "IsNativePostLoadActive", "IsNativePostLoadActive",
+            &InfiniteRandomizerFrameworkNative::IsNativePostLoadActive, {.isNative = true, .isStatic = true});
+
+        isNativePostLoadActive->SetReturnType("Bool");
+        customControllerClass.RegisterFunction(isNativePostLoadActive);
+
+        const auto getMemoryReport =
+            RED4ext::CClassStaticFunction::Create(&customControllerClass, "GetMemoryReport", "GetMemoryReport",
+            &InfiniteRandomizerFrameworkNative::GetMemoryReport, {.isNative = true, .isStatic = true});
+
+        getMemoryReport->SetReturnType("String");
+        customControllerClass.RegisterFunction(getMemoryReport);
+
+        const auto getPoolCatalog =
+            RED4ext::CClassStaticFunction::Create(&customControllerClass, "GetPoolCatalog", "GetPoolCatalog",
+            &InfiniteRandomizerFrameworkNative::GetPoolCatalog, {.isNative = true, .isStatic = true});
+
+        getPoolCatalog->SetReturnType("array:String");
+        customControllerClass.RegisterFunction(getPoolCatalog);
+
+        const auto exportBundle =
+            RED4ext::CClassStaticFunction::Create(&customControllerClass, "ExportBundle", "ExportBundle",
+            &InfiniteRandomizerFrameworkNative::ExportBundle, {.isNative = true, .isStatic = true});
+
+        exportBundle->AddParam("String", "name");
+        exportBundle->SetReturnType("Bool");
+        customControllerClass.RegisterFunction(exportBundle);
+
+        const auto setPoolEnabled =
+            RED4ext::CClassStaticFunction::Create(&customControllerClass, "SetPoolEnabled", "SetPoolEnabled",
+            &InfiniteRandomizerFrameworkNative::SetPoolEnabled, {.isNative = true, .isStatic = true});
+
+        setPoolEnabled->AddParam("String", "name");
+        setPoolEnabled->AddParam("Bool", "enabled");
+        setPoolEnabled->SetReturnType("Bool");
+        customControllerClass.RegisterFunction(setPoolEnabled);
     }
 
     RED4EXT_C_EXPORT bool RED4EXT_CALL Main(RED4ext::PluginHandle aHandle, RED4ext::EMainReason aReason, const RED4ext::Sdk* aSdk)
@@ -66,6 +104,9 @@ namespace InfiniteRandomizerFramework
             }
             case RED4ext::EMainReason::Unload:
             {
+                InfiniteRandomizerFrameworkNative::StopWatchingDataFiles();
+                InfiniteRandomizerFrameworkNative::UnhookSectorPostLoad();
+                InfiniteRandomizerFrameworkNative::SaveSectorManifest();
                 break;
             }
         }
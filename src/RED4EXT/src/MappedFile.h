@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+
+namespace InfiniteRandomizerFramework {
+    // a read only view of a whole file, the view stays valid until the file is closed
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        bool Open(const std::filesystem::path& path);
+        void Close();
+
+        [[nodiscard]] const std::byte* Data() const { return m_data; }
+        [[nodiscard]] size_t Size() const { return m_size; }
+
+    private:
+        const std::byte* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#endif
+    };
+}
@@ -0,0 +1,27 @@
+#include "MemoryPressure.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace InfiniteRandomizerFramework {
+    namespace {
+        constexpr int64_t g_sampleIntervalMs = 250;
+    }
+
+    float MemoryPressure::Current() {
+        const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        // only one of the threads that find the sample stale takes the next one, the others keep the previous level
+        auto sampledAt = m_sampledAt.load(std::memory_order_relaxed);
+        if (now - sampledAt >= g_sampleIntervalMs && m_sampledAt.compare_exchange_strong(sampledAt, now)) {
+            m_level.store(std::clamp(m_sampler(), 0.0f, 1.0f), std::memory_order_relaxed);
+        }
+
+        return m_level.load(std::memory_order_relaxed);
+    }
+
+    float MemoryPressure::FallbackChance(const float level, const float threshold) {
+        return threshold >= 1.0f ? 0.0f : std::clamp((level - threshold) / (1.0f - threshold), 0.0f, 1.0f);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+namespace InfiniteRandomizerFramework {
+    // how close the engine memory pools are to their budgets, 0 for empty and 1 for a full pool
+    class MemoryPressure {
+    public:
+        using Sampler = float (*)();
+
+        // a different sampler stands in for the engine pools where those are not available
+        explicit MemoryPressure(Sampler sampler = &SampleEnginePools) : m_sampler(sampler) {}
+
+        // the last sample, taken again once it is older than the sample interval
+        float Current();
+
+        // usage of the fullest budgeted pool that holds resources a swap can pull in
+        static float SampleEnginePools();
+
+        // chance a node keeps its original resource at a pressure level, rising from 0 at the threshold to 1 at a full
+        // pool. a threshold of 1 or above never falls back
+        static float FallbackChance(float level, float threshold);
+
+    private:
+        Sampler m_sampler;
+        std::atomic<float> m_level = 0.0f;
+        std::atomic<int64_t> m_sampledAt = 0;
+    };
+}
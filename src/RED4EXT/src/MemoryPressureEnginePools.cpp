@@ -0,0 +1,29 @@
+#include "MemoryPressure.h"
+
+#include <algorithm>
+
+#include "RED4ext/Memory/Pools.hpp"
+
+// the engine side of MemoryPressure, kept apart so the sampling logic builds without the sdk memory vault
+namespace InfiniteRandomizerFramework {
+    namespace {
+        float UsageOf(const RED4ext::Memory::PoolInfo* pool) {
+            if (!pool || pool->budget == 0 || !pool->storage) {
+                return 0.0f;
+            }
+            return static_cast<float>(static_cast<double>(pool->storage->bytesAllocated) / static_cast<double>(pool->budget));
+        }
+    }
+
+    float MemoryPressure::SampleEnginePools() {
+        using namespace RED4ext::Memory;
+
+        return std::max({
+            UsageOf(PoolCPU::Get()),
+            UsageOf(PoolGPU::Get()),
+            UsageOf(PoolTexture::Get()),
+            UsageOf(PoolMesh::Get()),
+            UsageOf(PoolEntity::Get()),
+        });
+    }
+}
@@ -0,0 +1,56 @@
+#include "ParallelJobs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "RED4ext/JobQueue.hpp"
+
+namespace InfiniteRandomizerFramework {
+    namespace {
+        // shared with the helper jobs, which may start after Run returned
+        struct SharedState {
+            SharedState(const size_t count, const std::function<void(size_t)>* body) : count(count), body(body) {}
+
+            const size_t count;
+            // only called for a claimed index, Run does not return before every claimed index finished
+            const std::function<void(size_t)>* body;
+            std::atomic<size_t> next = 0;
+            std::atomic<size_t> finished = 0;
+        };
+
+        void Drain(SharedState& state) {
+            for (auto i = state.next.fetch_add(1); i < state.count; i = state.next.fetch_add(1)) {
+                (*state.body)(i);
+                if (state.finished.fetch_add(1) + 1 == state.count) {
+                    state.finished.notify_all();
+                }
+            }
+        }
+    }
+
+    void ParallelJobs::Run(const size_t count, const std::function<void(size_t)>& body) {
+        if (count <= 1) {
+            if (count == 1) {
+                body(0);
+            }
+            return;
+        }
+
+        const auto state = std::make_shared<SharedState>(count, &body);
+        const auto helperCount = std::min<size_t>(count - 1, std::max(1u, std::thread::hardware_concurrency()) - 1);
+        for (size_t helper = 0; helper < helperCount; helper++) {
+            // jobs of one queue run one after another, every helper needs its own queue to run beside the others
+            RED4ext::JobQueue queue;
+            queue.Dispatch([state]() {
+                Drain(*state);
+            });
+        }
+
+        Drain(*state);
+        for (auto finished = state->finished.load(); finished < count; finished = state->finished.load()) {
+            state->finished.wait(finished);
+        }
+    }
+}
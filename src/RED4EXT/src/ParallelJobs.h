@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+
+namespace InfiniteRandomizerFramework {
+    // runs a body for every index in [0, count) on the calling thread and on helper jobs of the job system.
+    // the calling thread claims indices like the helpers do and afterwards only waits for indices a running helper
+    // is still working on, it never waits for a job that has not started. a saturated worker pool, or a caller that
+    // is itself a worker, degrades to running every index inline
+    class ParallelJobs {
+    public:
+        static void Run(size_t count, const std::function<void(size_t)>& body);
+    };
+}
@@ -0,0 +1,181 @@
+#include "ParseCache.h"
+
+#include <fstream>
+
+#include "CacheFile.h"
+
+namespace InfiniteRandomizerFramework {
+    namespace {
+        constexpr uint32_t g_parseCacheMagic = 0x43505249; // IRPC
+        constexpr uint32_t g_parseCacheVersion = 3;
+
+        void WriteValue(std::ostream& stream, const Category& category) {
+            CacheFile::Write(stream, category.extension);
+            CacheFile::Write(stream, static_cast<uint32_t>(category.entries.size()));
+            for (const auto& entry : category.entries) {
+                CacheFile::Write(stream, entry.resourcePath.hash);
+                CacheFile::Write(stream, entry.appearance.hash);
+            }
+        }
+
+        bool ReadValue(std::istream& stream, Category& category) {
+            uint32_t count = 0;
+            if (!CacheFile::Read(stream, category.extension) || !CacheFile::ReadLength(stream, count)) {
+                return false;
+            }
+
+            category.entries.resize(count);
+            for (auto& entry : category.entries) {
+                if (!CacheFile::Read(stream, entry.resourcePath.hash) || !CacheFile::Read(stream, entry.appearance.hash)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void WriteValue(std::ostream& stream, const VariantPool& pool) {
+            CacheFile::Write(stream, pool.extension);
+            CacheFile::Write(stream, pool.category);
+            CacheFile::Write(stream, static_cast<uint8_t>(pool.enabled));
+            CacheFile::Write(stream, static_cast<uint32_t>(pool.entries.size()));
+            for (const auto& entry : pool.entries) {
+                CacheFile::Write(stream, entry.resourcePath.hash);
+                CacheFile::Write(stream, entry.appearance);
+                CacheFile::Write(stream, entry.weight);
+            }
+        }
+
+        bool ReadValue(std::istream& stream, VariantPool& pool) {
+            uint32_t count = 0;
+            uint8_t enabled = 0;
+            if (!CacheFile::Read(stream, pool.extension) || !CacheFile::Read(stream, pool.category) || !CacheFile::Read(stream, enabled)
+                || !CacheFile::ReadLength(stream, count)) {
+                return false;
+            }
+            pool.enabled = enabled != 0;
+
+            pool.entries.resize(count);
+            for (auto& entry : pool.entries) {
+                if (!CacheFile::Read(stream, entry.resourcePath.hash) || !CacheFile::Read(stream, entry.appearance) || !CacheFile::Read(stream, entry.weight)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template<typename T>
+        void WriteFiles(std::ostream& stream, const ParseCache::Files<T>& files) {
+            CacheFile::Write(stream, static_cast<uint64_t>(files.size()));
+            for (const auto& [path, file] : files) {
+                CacheFile::Write(stream, path);
+                CacheFile::Write(stream, file.fingerprint);
+                CacheFile::Write(stream, file.name);
+                WriteValue(stream, file.value);
+            }
+        }
+
+        template<typename T>
+        bool ReadFiles(std::istream& stream, ParseCache::Files<T>& files) {
+            uint64_t count = 0;
+            if (!CacheFile::Read(stream, count)) {
+                return false;
+            }
+
+            for (uint64_t i = 0; i < count; i++) {
+                std::string path;
+                ParseCache::File<T> file{};
+                if (!CacheFile::Read(stream, path) || !CacheFile::Read(stream, file.fingerprint) || !CacheFile::Read(stream, file.name)
+                    || !ReadValue(stream, file.value)) {
+                    return false;
+                }
+                files.insert_or_assign(std::move(path), std::move(file));
+            }
+            return true;
+        }
+
+        size_t ValueMemoryUsage(const Category& category) {
+            return category.extension.capacity() + category.entries.capacity() * sizeof(CategoryEntry);
+        }
+
+        size_t ValueMemoryUsage(const VariantPool& pool) {
+            size_t bytes = pool.extension.capacity() + pool.category.capacity() + pool.entries.capacity() * sizeof(VariantPoolEntry);
+            for (const auto& entry : pool.entries) {
+                bytes += entry.appearance.capacity();
+            }
+            return bytes;
+        }
+
+        template<typename T>
+        size_t FilesMemoryUsage(const ParseCache::Files<T>& files) {
+            size_t bytes = files.bucket_count() * 2 * sizeof(void*);
+            for (const auto& [path, file] : files) {
+                bytes += sizeof(std::pair<const std::string, ParseCache::File<T>>) + 2 * sizeof(void*)
+                    + path.capacity() + file.name.capacity() + ValueMemoryUsage(file.value);
+            }
+            return bytes;
+        }
+    }
+
+    ParseCache::Files<Category>& ParseCache::Categories() {
+        return m_categories;
+    }
+
+    ParseCache::Files<VariantPool>& ParseCache::VariantPools() {
+        return m_variantPools;
+    }
+
+    void ParseCache::MarkDirty() {
+        m_dirty = true;
+    }
+
+    bool ParseCache::Load(const std::filesystem::path& path) {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream) {
+            return false;
+        }
+
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        if (!CacheFile::Read(stream, magic) || !CacheFile::Read(stream, version) || magic != g_parseCacheMagic || version != g_parseCacheVersion) {
+            return false;
+        }
+
+        Files<Category> categories;
+        Files<VariantPool> variantPools;
+        if (!ReadFiles(stream, categories) || !ReadFiles(stream, variantPools)) {
+            return false;
+        }
+
+        m_categories = std::move(categories);
+        m_variantPools = std::move(variantPools);
+        m_dirty = false;
+        return true;
+    }
+
+    bool ParseCache::Save(const std::filesystem::path& path) {
+        if (!m_dirty) {
+            return true;
+        }
+
+        const auto saved = CacheFile::Save(path, [this](std::ostream& stream) {
+            CacheFile::Write(stream, g_parseCacheMagic);
+            CacheFile::Write(stream, g_parseCacheVersion);
+            WriteFiles(stream, m_categories);
+            WriteFiles(stream, m_variantPools);
+        });
+        if (!saved) {
+            return false;
+        }
+
+        m_dirty = false;
+        return true;
+    }
+
+    size_t ParseCache::Size() const {
+        return m_categories.size() + m_variantPools.size();
+    }
+
+    size_t ParseCache::MemoryUsage() const {
+        return FilesMemoryUsage(m_categories) + FilesMemoryUsage(m_variantPools);
+    }
+}
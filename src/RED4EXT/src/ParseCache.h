@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+
+#include "DataStructs/Category.h"
+#include "DataStructs/VariantPool.h"
+
+namespace InfiniteRandomizerFramework {
+    // remembers the parsed form of every category and variant pool file together with the fingerprint it was parsed from
+    // a reload only parses files whose fingerprint changed, only used by the loading thread
+    class ParseCache {
+    public:
+        struct Fingerprint {
+            uint64_t size;
+            int64_t writeTime;
+            uint64_t contentHash;
+        };
+
+        // only files that parsed are kept, a rejected file is parsed again on every load so its errors are logged again
+        template<typename T>
+        struct File {
+            Fingerprint fingerprint;
+            std::string name;
+            T value;
+        };
+
+        template<typename T>
+        using Files = std::unordered_map<std::string, File<T>>;
+
+        Files<Category>& Categories();
+        Files<VariantPool>& VariantPools();
+        // called after a file was parsed or its fingerprint was refreshed
+        void MarkDirty();
+
+        bool Load(const std::filesystem::path& path);
+        bool Save(const std::filesystem::path& path);
+
+        [[nodiscard]] size_t Size() const;
+        [[nodiscard]] size_t MemoryUsage() const;
+
+    private:
+        Files<Category> m_categories;
+        Files<VariantPool> m_variantPools;
+        bool m_dirty = false;
+    };
+}
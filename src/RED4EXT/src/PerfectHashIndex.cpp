@@ -0,0 +1,142 @@
+#include "PerfectHashIndex.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace InfiniteRandomizerFramework {
+    namespace {
+        // average keys per bucket, 16 bit pilots then cost ~3.2 bits per key
+        constexpr uint32_t g_bucketLoad = 5;
+        // slack in the intermediate table keeps the pilot search for the last buckets short
+        constexpr float g_loadFactor = 0.98f;
+        constexpr uint32_t g_maxSeedAttempts = 16;
+    }
+
+    void PerfectHashIndex::Clear() {
+        m_seed = 0;
+        m_tableSize = 0;
+        m_pilots.clear();
+        m_remap.clear();
+        m_keys.clear();
+    }
+
+    bool PerfectHashIndex::Build(const std::vector<uint64_t>& keys) {
+        Clear();
+        if (keys.empty()) {
+            return true;
+        }
+
+        const auto keyCount = static_cast<uint32_t>(keys.size());
+        const auto bucketCount = std::max<uint32_t>(1, keyCount / g_bucketLoad);
+        const auto tableSize = std::max<uint32_t>(keyCount, static_cast<uint32_t>(keyCount / g_loadFactor) + 1);
+
+        std::vector<uint64_t> mixedKeys(keyCount);
+        std::vector<uint32_t> bucketStarts(bucketCount + 1);
+        std::vector<uint32_t> bucketKeys(keyCount);
+        std::vector<uint32_t> bucketOrder(bucketCount);
+        std::vector<uint32_t> positions;
+        std::vector<uint16_t> pilots(bucketCount);
+        std::vector<uint32_t> slotOwner(tableSize);
+        std::vector<uint8_t> taken(tableSize);
+
+        m_pilots.resize(bucketCount);
+        m_tableSize = tableSize;
+
+        for (uint32_t attempt = 0; attempt < g_maxSeedAttempts; attempt++) {
+            const uint64_t seed = Mix(0x9e3779b97f4a7c15ULL * (attempt + 1));
+
+            // counting sort of the keys into their buckets
+            std::ranges::fill(bucketStarts, 0);
+            for (uint32_t i = 0; i < keyCount; i++) {
+                mixedKeys[i] = Mix(keys[i] ^ seed);
+                bucketStarts[BucketOf(mixedKeys[i]) + 1]++;
+            }
+            std::partial_sum(bucketStarts.begin(), bucketStarts.end(), bucketStarts.begin());
+            std::vector<uint32_t> fill(bucketStarts.begin(), bucketStarts.end() - 1);
+            for (uint32_t i = 0; i < keyCount; i++) {
+                bucketKeys[fill[BucketOf(mixedKeys[i])]++] = i;
+            }
+
+            std::iota(bucketOrder.begin(), bucketOrder.end(), 0);
+            std::ranges::stable_sort(bucketOrder, [&](uint32_t a, uint32_t b) {
+                return bucketStarts[a + 1] - bucketStarts[a] > bucketStarts[b + 1] - bucketStarts[b];
+            });
+
+            std::ranges::fill(taken, 0);
+            bool placedAll = true;
+
+            // largest buckets first, each one searches for a pilot that sends all of its keys to free, distinct positions
+            for (const auto bucket : bucketOrder) {
+                const auto begin = bucketStarts[bucket];
+                const auto end = bucketStarts[bucket + 1];
+                if (begin == end) {
+                    pilots[bucket] = 0;
+                    continue;
+                }
+
+                bool placed = false;
+                for (uint32_t pilot = 0; pilot <= UINT16_MAX && !placed; pilot++) {
+                    positions.clear();
+                    placed = true;
+                    for (auto i = begin; i < end; i++) {
+                        const auto position = PositionOf(mixedKeys[bucketKeys[i]], static_cast<uint16_t>(pilot));
+                        if (taken[position] || std::ranges::find(positions, position) != positions.end()) {
+                            placed = false;
+                            break;
+                        }
+                        positions.push_back(position);
+                    }
+
+                    if (placed) {
+                        pilots[bucket] = static_cast<uint16_t>(pilot);
+                        for (auto i = begin; i < end; i++) {
+                            taken[positions[i - begin]] = 1;
+                            slotOwner[positions[i - begin]] = bucketKeys[i];
+                        }
+                    }
+                }
+
+                if (!placed) {
+                    placedAll = false;
+                    break;
+                }
+            }
+
+            if (!placedAll) {
+                continue;
+            }
+
+            m_seed = seed;
+            m_pilots = std::move(pilots);
+            m_keys.resize(keyCount);
+            m_remap.assign(tableSize - keyCount, 0);
+
+            uint32_t freeSlot = 0;
+            for (uint32_t position = 0; position < tableSize; position++) {
+                if (!taken[position]) {
+                    continue;
+                }
+
+                auto slot = position;
+                if (position >= keyCount) {
+                    while (taken[freeSlot]) {
+                        freeSlot++;
+                    }
+                    slot = freeSlot++;
+                    m_remap[position - keyCount] = slot;
+                }
+                m_keys[slot] = keys[slotOwner[position]];
+            }
+            return true;
+        }
+
+        Clear();
+        return false;
+    }
+
+    size_t PerfectHashIndex::MemoryUsage() const {
+        return m_pilots.capacity() * sizeof(uint16_t)
+            + m_remap.capacity() * sizeof(uint32_t)
+            + m_keys.capacity() * sizeof(uint64_t);
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <xmmintrin.h>
+
+namespace InfiniteRandomizerFramework {
+    // PTHash style minimal perfect hash over a fixed set of 64 bit keys
+    // every key maps to a unique slot in [0, size), lookups verify against the stored key to reject foreign keys
+    class PerfectHashIndex {
+    public:
+        static constexpr uint32_t npos = UINT32_MAX;
+
+        // keys must be unique, returns false if no placement was found
+        bool Build(const std::vector<uint64_t>& keys);
+        void Clear();
+
+        [[nodiscard]] uint32_t Find(uint64_t key) const {
+            if (m_keys.empty()) {
+                return npos;
+            }
+            const auto slot = SlotOf(key);
+            return m_keys[slot] == key ? slot : npos;
+        }
+
+        // split lookup for batched probing: prefetch the bucket, then locate and prefetch the slot, then verify
+        void PrefetchBucket(uint64_t key) const {
+            if (!m_keys.empty()) {
+                _mm_prefetch(reinterpret_cast<const char*>(&m_pilots[BucketOf(Mix(key ^ m_seed))]), _MM_HINT_T0);
+            }
+        }
+
+        [[nodiscard]] uint32_t Locate(uint64_t key) const {
+            return m_keys.empty() ? npos : SlotOf(key);
+        }
+
+        void PrefetchSlot(uint32_t slot) const {
+            _mm_prefetch(reinterpret_cast<const char*>(&m_keys[slot]), _MM_HINT_T0);
+        }
+
+        [[nodiscard]] bool Verify(uint32_t slot, uint64_t key) const {
+            return m_keys[slot] == key;
+        }
+
+        [[nodiscard]] uint32_t Size() const { return static_cast<uint32_t>(m_keys.size()); }
+        [[nodiscard]] uint64_t KeyAt(uint32_t slot) const { return m_keys[slot]; }
+        [[nodiscard]] size_t MemoryUsage() const;
+
+    private:
+        uint64_t m_seed = 0;
+        uint32_t m_tableSize = 0;
+        std::vector<uint16_t> m_pilots;
+        // positions past the key count are folded back onto the free slots below it
+        std::vector<uint32_t> m_remap;
+        std::vector<uint64_t> m_keys;
+
+        static uint64_t Mix(uint64_t value) {
+            value ^= value >> 33;
+            value *= 0xff51afd7ed558ccdULL;
+            value ^= value >> 33;
+            value *= 0xc4ceb9fe1a85ec53ULL;
+            value ^= value >> 33;
+            return value;
+        }
+
+        [[nodiscard]] uint32_t BucketOf(uint64_t mixedKey) const {
+            return static_cast<uint32_t>((mixedKey >> 32) % m_pilots.size());
+        }
+
+        [[nodiscard]] uint32_t PositionOf(uint64_t mixedKey, uint16_t pilot) const {
+            return static_cast<uint32_t>((mixedKey ^ Mix(pilot + 1)) % m_tableSize);
+        }
+
+        [[nodiscard]] uint32_t SlotOf(uint64_t key) const {
+            const auto mixedKey = Mix(key ^ m_seed);
+            const auto position = PositionOf(mixedKey, m_pilots[BucketOf(mixedKey)]);
+            return position < m_keys.size() ? position : m_remap[position - m_keys.size()];
+        }
+    };
+}
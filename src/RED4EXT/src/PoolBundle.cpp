@@ -0,0 +1,252 @@
+#include "PoolBundle.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <ostream>
+
+#include "CacheFile.h"
+
+namespace InfiniteRandomizerFramework {
+    namespace {
+        constexpr uint32_t g_bundleMagic = 0x42465249; // IRFB
+        constexpr uint32_t g_bundleVersion = 1;
+        constexpr uint32_t g_poolEnabled = 1;
+
+        struct StringRef {
+            uint32_t offset;
+            uint32_t length;
+        };
+
+        struct Header {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t categoryCount;
+            uint32_t poolCount;
+            uint32_t categoryEntryCount;
+            uint32_t poolEntryCount;
+            uint64_t stringTableOffset;
+            uint64_t stringTableSize;
+            uint64_t categoryOffset;
+            uint64_t poolOffset;
+            uint64_t categoryEntryOffset;
+            uint64_t poolEntryOffset;
+        };
+
+        struct CategoryRecord {
+            StringRef name;
+            StringRef extension;
+            uint32_t firstEntry;
+            uint32_t entryCount;
+        };
+
+        struct PoolRecord {
+            StringRef name;
+            StringRef category;
+            StringRef extension;
+            uint32_t firstEntry;
+            uint32_t entryCount;
+            uint32_t flags;
+            uint32_t reserved;
+        };
+
+        struct CategoryEntryRecord {
+            uint64_t resourcePath;
+            uint64_t appearance;
+        };
+
+        struct PoolEntryRecord {
+            uint64_t resourcePath;
+            StringRef appearance;
+            float weight;
+            uint32_t reserved;
+        };
+
+        static_assert(sizeof(Header) == 72);
+        static_assert(sizeof(CategoryRecord) == 24);
+        static_assert(sizeof(PoolRecord) == 40);
+        static_assert(sizeof(CategoryEntryRecord) == 16);
+        static_assert(sizeof(PoolEntryRecord) == 24);
+
+        // every section starts 8 byte aligned so its records can be used in place
+        constexpr uint64_t Align(const uint64_t offset) {
+            return (offset + 7) & ~uint64_t(7);
+        }
+
+        class StringTable {
+        public:
+            StringRef Add(const std::string& value) {
+                const auto [it, inserted] = m_offsets.try_emplace(value, static_cast<uint32_t>(m_bytes.size()));
+                if (inserted) {
+                    m_bytes.insert(m_bytes.end(), value.begin(), value.end());
+                }
+                return {it->second, static_cast<uint32_t>(value.size())};
+            }
+
+            [[nodiscard]] const std::vector<char>& Bytes() const { return m_bytes; }
+
+        private:
+            std::unordered_map<std::string, uint32_t> m_offsets;
+            std::vector<char> m_bytes;
+        };
+
+        template<typename T>
+        void WriteSection(std::ostream& stream, const uint64_t offset, const std::vector<T>& records) {
+            constexpr char padding[8] = {};
+            const auto position = static_cast<uint64_t>(stream.tellp());
+            stream.write(padding, static_cast<std::streamsize>(offset - position));
+            stream.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(T)));
+        }
+
+        // null if the section does not fit into the bundle or is misaligned
+        template<typename T>
+        const T* Section(const std::byte* data, const size_t size, const uint64_t offset, const uint64_t count) {
+            if (offset % alignof(T) != 0 || offset > size || count > (size - offset) / sizeof(T)) {
+                return nullptr;
+            }
+            return reinterpret_cast<const T*>(data + offset);
+        }
+
+        template<typename Map>
+        std::vector<const typename Map::value_type*> SortedByName(const Map& map) {
+            std::vector<const typename Map::value_type*> sorted;
+            sorted.reserve(map.size());
+            for (const auto& entry : map) {
+                sorted.push_back(&entry);
+            }
+            std::ranges::sort(sorted, {}, [](const auto* entry) { return entry->first; });
+            return sorted;
+        }
+    }
+
+    bool PoolBundle::Write(const std::filesystem::path& path,
+                           const std::unordered_map<std::string, Category>& categories,
+                           const std::unordered_map<std::string, VariantPool>& pools) {
+        StringTable strings;
+        std::vector<CategoryRecord> categoryRecords;
+        std::vector<PoolRecord> poolRecords;
+        std::vector<CategoryEntryRecord> categoryEntries;
+        std::vector<PoolEntryRecord> poolEntries;
+
+        // sorted so the same data always produces the same bundle
+        for (const auto* category : SortedByName(categories)) {
+            categoryRecords.push_back({strings.Add(category->first), strings.Add(category->second.extension),
+                                       static_cast<uint32_t>(categoryEntries.size()),
+                                       static_cast<uint32_t>(category->second.entries.size())});
+            for (const auto& entry : category->second.entries) {
+                categoryEntries.push_back({entry.resourcePath.hash, entry.appearance.hash});
+            }
+        }
+
+        for (const auto* pool : SortedByName(pools)) {
+            poolRecords.push_back({strings.Add(pool->first), strings.Add(pool->second.category), strings.Add(pool->second.extension),
+                                   static_cast<uint32_t>(poolEntries.size()), static_cast<uint32_t>(pool->second.entries.size()),
+                                   pool->second.enabled ? g_poolEnabled : 0, 0});
+            for (const auto& entry : pool->second.entries) {
+                poolEntries.push_back({entry.resourcePath.hash, strings.Add(entry.appearance), entry.weight, 0});
+            }
+        }
+
+        Header header{};
+        header.magic = g_bundleMagic;
+        header.version = g_bundleVersion;
+        header.categoryCount = static_cast<uint32_t>(categoryRecords.size());
+        header.poolCount = static_cast<uint32_t>(poolRecords.size());
+        header.categoryEntryCount = static_cast<uint32_t>(categoryEntries.size());
+        header.poolEntryCount = static_cast<uint32_t>(poolEntries.size());
+        header.categoryOffset = sizeof(Header);
+        header.poolOffset = Align(header.categoryOffset + categoryRecords.size() * sizeof(CategoryRecord));
+        header.categoryEntryOffset = Align(header.poolOffset + poolRecords.size() * sizeof(PoolRecord));
+        header.poolEntryOffset = Align(header.categoryEntryOffset + categoryEntries.size() * sizeof(CategoryEntryRecord));
+        header.stringTableOffset = Align(header.poolEntryOffset + poolEntries.size() * sizeof(PoolEntryRecord));
+        header.stringTableSize = strings.Bytes().size();
+
+        return CacheFile::Save(path, [&](std::ostream& stream) {
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+            WriteSection(stream, header.categoryOffset, categoryRecords);
+            WriteSection(stream, header.poolOffset, poolRecords);
+            WriteSection(stream, header.categoryEntryOffset, categoryEntries);
+            WriteSection(stream, header.poolEntryOffset, poolEntries);
+            WriteSection(stream, header.stringTableOffset, strings.Bytes());
+        });
+    }
+
+    bool PoolBundle::Read(const std::byte* data, const size_t size,
+                          std::vector<std::pair<std::string, Category>>& categories,
+                          std::vector<std::pair<std::string, VariantPool>>& pools) {
+        Header header{};
+        if (size < sizeof(Header)) {
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(Header));
+        if (header.magic != g_bundleMagic || header.version != g_bundleVersion) {
+            return false;
+        }
+
+        const auto* categoryRecords = Section<CategoryRecord>(data, size, header.categoryOffset, header.categoryCount);
+        const auto* poolRecords = Section<PoolRecord>(data, size, header.poolOffset, header.poolCount);
+        const auto* categoryEntries = Section<CategoryEntryRecord>(data, size, header.categoryEntryOffset, header.categoryEntryCount);
+        const auto* poolEntries = Section<PoolEntryRecord>(data, size, header.poolEntryOffset, header.poolEntryCount);
+        const auto* stringTable = Section<char>(data, size, header.stringTableOffset, header.stringTableSize);
+        if (!categoryRecords || !poolRecords || !categoryEntries || !poolEntries || !stringTable) {
+            return false;
+        }
+
+        bool valid = true;
+        const auto string = [&](const StringRef ref) {
+            if (ref.offset > header.stringTableSize || ref.length > header.stringTableSize - ref.offset) {
+                valid = false;
+                return std::string();
+            }
+            return std::string(stringTable + ref.offset, ref.length);
+        };
+        const auto inRange = [](const uint32_t first, const uint32_t count, const uint32_t total) {
+            return first <= total && count <= total - first;
+        };
+
+        std::vector<std::pair<std::string, Category>> readCategories;
+        readCategories.reserve(header.categoryCount);
+        for (uint32_t i = 0; i < header.categoryCount; i++) {
+            const auto& record = categoryRecords[i];
+            if (!inRange(record.firstEntry, record.entryCount, header.categoryEntryCount)) {
+                return false;
+            }
+
+            Category category;
+            category.extension = string(record.extension);
+            category.entries.reserve(record.entryCount);
+            for (uint32_t j = 0; j < record.entryCount; j++) {
+                const auto& entry = categoryEntries[record.firstEntry + j];
+                category.entries.push_back({RED4ext::ResourcePath(entry.resourcePath), RED4ext::CName(entry.appearance)});
+            }
+            readCategories.emplace_back(string(record.name), std::move(category));
+        }
+
+        std::vector<std::pair<std::string, VariantPool>> readPools;
+        readPools.reserve(header.poolCount);
+        for (uint32_t i = 0; i < header.poolCount; i++) {
+            const auto& record = poolRecords[i];
+            if (!inRange(record.firstEntry, record.entryCount, header.poolEntryCount)) {
+                return false;
+            }
+            VariantPool pool;
+            pool.enabled = (record.flags & g_poolEnabled) != 0;
+            pool.extension = string(record.extension);
+            pool.category = string(record.category);
+            pool.entries.reserve(record.entryCount);
+            for (uint32_t j = 0; j < record.entryCount; j++) {
+                const auto& entry = poolEntries[record.firstEntry + j];
+                pool.entries.push_back({RED4ext::ResourcePath(entry.resourcePath), string(entry.appearance), entry.weight});
+            }
+            readPools.emplace_back(string(record.name), std::move(pool));
+        }
+
+        if (!valid) {
+            return false;
+        }
+
+        std::ranges::move(readCategories, std::back_inserter(categories));
+        std::ranges::move(readPools, std::back_inserter(pools));
+        return true;
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "DataStructs/Category.h"
+#include "DataStructs/VariantPool.h"
+
+namespace InfiniteRandomizerFramework {
+    // many categories and variant pools packed into one file, a header is followed by fixed size records and a string
+    // table they refer into. the records are read from a mapping of the file without parsing, but copied into the same
+    // categories and pools the JSON files produce, the mapping is not needed once a bundle is read
+    class PoolBundle {
+    public:
+        static constexpr auto Extension = ".irfbundle";
+
+        static bool Write(const std::filesystem::path& path,
+                          const std::unordered_map<std::string, Category>& categories,
+                          const std::unordered_map<std::string, VariantPool>& pools);
+
+        // rejects the whole bundle if any record points outside of it. the records are not validated, see DataParser
+        static bool Read(const std::byte* data, size_t size,
+                         std::vector<std::pair<std::string, Category>>& categories,
+                         std::vector<std::pair<std::string, VariantPool>>& pools);
+    };
+}
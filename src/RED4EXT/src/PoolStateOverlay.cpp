@@ -0,0 +1,108 @@
+#include "PoolStateOverlay.h"
+
+#include <format>
+#include <fstream>
+#include <sstream>
+
+#include <RapidJson/document.h>
+#include <RapidJson/error/en.h>
+#include <RapidJson/prettywriter.h>
+#include <RapidJson/stringbuffer.h>
+
+#include "CacheFile.h"
+#include "RedLogger.h"
+
+namespace InfiniteRandomizerFramework {
+    bool PoolStateOverlay::IsEnabled(const std::string& name, const bool fileEnabled) const {
+        const auto it = m_states.find(name);
+        return it == m_states.end() ? fileEnabled : it->second;
+    }
+
+    void PoolStateOverlay::Set(const std::string& name, const bool enabled) {
+        m_states.insert_or_assign(name, enabled);
+    }
+
+    namespace {
+        // keeps a file the overlay cannot use where the player can repair it, false if it stays in place
+        bool MoveAside(const std::filesystem::path& path) {
+            auto backupPath = path;
+            backupPath += ".bak";
+
+            std::error_code error;
+            std::filesystem::rename(path, backupPath, error);
+            if (error) {
+                RedLogger::Error(std::format("Failed to move the pool states aside to {}, changes to pool states are not saved until they load.",
+                    backupPath.filename().string()));
+                return false;
+            }
+            RedLogger::Warning(std::format("Moved the unusable pool states to {}.", backupPath.filename().string()));
+            return true;
+        }
+    }
+
+    bool PoolStateOverlay::Load(const std::filesystem::path& path) {
+        m_states.clear();
+        m_saveBlocked = false;
+
+        std::ifstream fileStream(path, std::ios::binary);
+        if (!fileStream) {
+            std::error_code error;
+            if (!std::filesystem::exists(path, error) && !error) {
+                return true;
+            }
+            RedLogger::Error("Failed to open pool states, changes to pool states are not saved until they load.");
+            m_saveBlocked = true;
+            return false;
+        }
+
+        std::stringstream buffer;
+        buffer << fileStream.rdbuf();
+        fileStream.close();
+
+        rapidjson::Document doc;
+        doc.Parse(buffer.str().c_str());
+        if (doc.HasParseError()) {
+            RedLogger::Error(std::format("Failed to parse pool states with error {}, ignoring them.", rapidjson::GetParseError_En(doc.GetParseError())));
+            m_saveBlocked = !MoveAside(path);
+            return false;
+        }
+        if (!doc.IsObject()) {
+            RedLogger::Error("Pool states are malformed: root is not of type object, ignoring them.");
+            m_saveBlocked = !MoveAside(path);
+            return false;
+        }
+
+        for (const auto& member : doc.GetObject()) {
+            if (!member.value.IsBool()) {
+                RedLogger::Warning(std::format("Pool states are malformed: state of `{}` is not of type bool, ignoring it.", member.name.GetString()));
+                continue;
+            }
+            m_states.insert_or_assign(member.name.GetString(), member.value.GetBool());
+        }
+        return true;
+    }
+
+    bool PoolStateOverlay::Save(const std::filesystem::path& path) const {
+        if (m_saveBlocked) {
+            return false;
+        }
+
+        rapidjson::StringBuffer buffer;
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+        writer.SetIndent(' ', 2);
+        writer.StartObject();
+        for (const auto& [name, enabled] : m_states) {
+            writer.Key(name.c_str(), static_cast<rapidjson::SizeType>(name.size()));
+            writer.Bool(enabled);
+        }
+        writer.EndObject();
+
+        return CacheFile::Save(path, [&buffer](std::ostream& stream) {
+            stream.write(buffer.GetString(), static_cast<std::streamsize>(buffer.GetSize()));
+        });
+    }
+
+    size_t PoolStateOverlay::Size() const {
+        return m_states.size();
+    }
+}
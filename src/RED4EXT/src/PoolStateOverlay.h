@@ -0,0 +1,28 @@
+#pragma once
+#include <filesystem>
+#include <map>
+#include <string>
+
+namespace InfiniteRandomizerFramework {
+    // enabled state chosen for variant pools in the overlay, takes precedence over the `enabled` property of pool files
+    // and bundles, so toggling a pool never rewrites the pool itself
+    // only used while holding the load mutex
+    class PoolStateOverlay {
+    public:
+        [[nodiscard]] bool IsEnabled(const std::string& name, bool fileEnabled) const;
+        void Set(const std::string& name, bool enabled);
+
+        // a missing file is an empty overlay, returns false if the file is unreadable or malformed. a malformed file is
+        // moved aside to .bak, so the next save does not replace the states the player set with the one just toggled
+        bool Load(const std::filesystem::path& path);
+        // fails while the last load left a file that could neither be read nor moved aside
+        bool Save(const std::filesystem::path& path) const;
+
+        [[nodiscard]] size_t Size() const;
+
+    private:
+        // ordered so the file stays stable across saves
+        std::map<std::string, bool> m_states;
+        bool m_saveBlocked = false;
+    };
+}
@@ -0,0 +1,75 @@
+#include "ResidencyCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+#include "DataStructs/MemoryReport.h"
+#include "RED4ext/ResourceLoader.hpp"
+
+namespace InfiniteRandomizerFramework {
+    namespace {
+        constexpr int64_t g_epochMs = 100;
+    }
+
+    void ResidencyCache::Collect(const std::vector<uint64_t>& resourcePaths, std::vector<uint64_t>& residentPaths) {
+        const auto epoch = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count() / g_epochMs;
+
+        // the first thread into a new epoch drops the previous answers, the others find them gone
+        if (auto current = m_epoch.load(std::memory_order_relaxed); current != epoch && m_epoch.compare_exchange_strong(current, epoch)) {
+            std::unique_lock lock(m_mutex);
+            m_resident.clear();
+        }
+
+        thread_local std::vector<uint64_t> unknownPaths;
+        unknownPaths.clear();
+        const auto first = static_cast<ptrdiff_t>(residentPaths.size());
+
+        {
+            std::shared_lock lock(m_mutex);
+            for (const auto resourcePath : resourcePaths) {
+                const auto it = m_resident.find(resourcePath);
+                if (it == m_resident.end()) {
+                    unknownPaths.push_back(resourcePath);
+                } else if (it->second) {
+                    residentPaths.push_back(resourcePath);
+                }
+            }
+        }
+
+        if (unknownPaths.empty()) {
+            return;
+        }
+
+        // the loader is asked without holding the lock, threads racing on a path store the same answer
+        const auto known = static_cast<ptrdiff_t>(residentPaths.size());
+        auto* loader = RED4ext::ResourceLoader::Get();
+        for (const auto resourcePath : unknownPaths) {
+            const auto token = loader->FindToken(resourcePath);
+            if (token && token->IsLoaded()) {
+                residentPaths.push_back(resourcePath);
+            }
+        }
+
+        {
+            std::unique_lock lock(m_mutex);
+            auto resident = residentPaths.begin() + known;
+            for (const auto resourcePath : unknownPaths) {
+                const auto isResident = resident != residentPaths.end() && *resident == resourcePath;
+                m_resident.insert_or_assign(resourcePath, isResident);
+                if (isResident) {
+                    ++resident;
+                }
+            }
+        }
+
+        // cached and freshly asked paths were appended separately
+        std::inplace_merge(residentPaths.begin() + first, residentPaths.begin() + known, residentPaths.end());
+    }
+
+    size_t ResidencyCache::MemoryUsage() const {
+        std::shared_lock lock(m_mutex);
+        return m_resident.size() * HashNodeBytes<uint64_t, bool>() + m_resident.bucket_count() * sizeof(void*);
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace InfiniteRandomizerFramework {
+    // remembers which replacement paths the resource loader holds, so sectors streamed in together share one lookup per path.
+    // answers are dropped once they are older than a few frames, residency only steers selection and may lag that much
+    class ResidencyCache {
+    public:
+        // appends the resident ones of the given paths, expects them sorted and without duplicates and keeps that order
+        void Collect(const std::vector<uint64_t>& resourcePaths, std::vector<uint64_t>& residentPaths);
+
+        [[nodiscard]] size_t MemoryUsage() const;
+
+    private:
+        mutable std::shared_mutex m_mutex;
+        std::atomic<int64_t> m_epoch = 0;
+        std::unordered_map<uint64_t, bool> m_resident;
+    };
+}
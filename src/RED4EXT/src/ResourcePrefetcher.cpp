@@ -0,0 +1,53 @@
+#include "ResourcePrefetcher.h"
+
+namespace InfiniteRandomizerFramework {
+    size_t ResourcePrefetcher::Request(const std::vector<uint64_t>& resourcePaths) {
+        std::lock_guard lock(m_mutex);
+
+        size_t issued = 0;
+        for (const auto resourcePath : resourcePaths) {
+            if (!m_requestedPaths.insert(resourcePath).second) {
+                continue;
+            }
+
+            auto token = RED4ext::ResourceLoader::Get()->LoadAsync(resourcePath);
+            if (!token) {
+                m_requestedPaths.erase(resourcePath);
+                continue;
+            }
+
+            m_requests.push_back({resourcePath, std::move(token)});
+            issued++;
+        }
+
+        Evict();
+        return issued;
+    }
+
+    void ResourcePrefetcher::Evict() {
+        // requests still loading are never cancelled, they stay until they finish even if that exceeds the capacity
+        while (m_requests.size() > m_capacity && m_requests.front().token->IsFinished()) {
+            m_requestedPaths.erase(m_requests.front().resourcePath);
+            m_requests.pop_front();
+        }
+    }
+
+    void ResourcePrefetcher::Clear() {
+        std::lock_guard lock(m_mutex);
+
+        m_requests.clear();
+        m_requestedPaths.clear();
+    }
+
+    size_t ResourcePrefetcher::Size() const {
+        std::lock_guard lock(m_mutex);
+        return m_requests.size();
+    }
+
+    size_t ResourcePrefetcher::MemoryUsage() const {
+        std::lock_guard lock(m_mutex);
+        return m_requests.size() * sizeof(PendingRequest)
+            + m_requestedPaths.size() * (sizeof(uint64_t) + 2 * sizeof(void*))
+            + m_requestedPaths.bucket_count() * sizeof(void*);
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "RED4ext/ResourceLoader.hpp"
+
+namespace InfiniteRandomizerFramework {
+    // keeps async load requests for chosen replacements alive until the nodes that use them had time to spawn
+    // a path is only requested again once its previous request was released
+    class ResourcePrefetcher {
+    public:
+        explicit ResourcePrefetcher(size_t capacity) : m_capacity(capacity) {}
+
+        // expects the paths of one sector sorted and without duplicates, returns how many requests were issued
+        size_t Request(const std::vector<uint64_t>& resourcePaths);
+        void Clear();
+
+        [[nodiscard]] size_t Size() const;
+        [[nodiscard]] size_t MemoryUsage() const;
+
+    private:
+        struct PendingRequest {
+            uint64_t resourcePath;
+            RED4ext::SharedPtr<RED4ext::ResourceToken<>> token;
+        };
+
+        // releases the oldest finished requests while more than the capacity are held
+        void Evict();
+
+        size_t m_capacity;
+        mutable std::mutex m_mutex;
+        std::deque<PendingRequest> m_requests;
+        std::unordered_set<uint64_t> m_requestedPaths;
+    };
+}
@@ -0,0 +1,103 @@
+#include "ResourceValidationCache.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <mutex>
+
+#include "ParallelJobs.h"
+#include "DataStructs/Globals.h"
+#include "DataStructs/MemoryReport.h"
+#include "xxhash64.h"
+
+namespace InfiniteRandomizerFramework {
+    uint64_t ResourceValidationCache::ArchiveFingerprint(const RED4ext::ResourceDepot* depot) {
+        XXHash64 hash(0);
+        for (const auto& group : depot->groups) {
+            for (const auto& archive : group.archives) {
+                hash.add(archive.path.c_str(), archive.path.Length());
+                // separates the paths so moving a character between neighbours changes the fingerprint
+                hash.add("\0", 1);
+
+                // a mod updating its archive in place keeps the path, an archive that cannot be looked at hashes as empty
+                std::filesystem::path archivePath(archive.path.c_str());
+                if (archivePath.is_relative()) {
+                    archivePath = std::filesystem::path(depot->rootPath.c_str()) / archivePath;
+                }
+                uint64_t stamp[2] = {};
+                std::error_code error;
+                const std::filesystem::directory_entry file(archivePath, error);
+                if (!error && file.is_regular_file(error)) {
+                    stamp[0] = file.file_size(error);
+                    stamp[1] = static_cast<uint64_t>(file.last_write_time(error).time_since_epoch().count());
+                }
+                hash.add(stamp, sizeof(stamp));
+            }
+        }
+        return hash.hash();
+    }
+
+    size_t ResourceValidationCache::Validate(RED4ext::ResourceDepot* depot, const std::vector<uint64_t>& resourcePaths) {
+        const auto archiveFingerprint = ArchiveFingerprint(depot);
+
+        std::vector<uint64_t> uncached;
+        {
+            std::unique_lock lock(m_mutex);
+            if (archiveFingerprint != m_archiveFingerprint) {
+                m_results.clear();
+                m_archiveFingerprint = archiveFingerprint;
+            }
+
+            for (const auto resourcePath : resourcePaths) {
+                if (!m_results.contains(resourcePath)) {
+                    uncached.push_back(resourcePath);
+                }
+            }
+        }
+
+        std::ranges::sort(uncached);
+        const auto [first, last] = std::ranges::unique(uncached);
+        uncached.erase(first, last);
+        if (uncached.empty()) {
+            return 0;
+        }
+
+        // the depot lookups are independent, large batches are split across the job system like large sectors
+        std::vector<uint8_t> exists(uncached.size());
+        const auto validateChunk = [depot, &uncached, &exists](const size_t chunk) {
+            const auto begin = chunk * g_validationChunkSize;
+            const auto end = std::min(begin + g_validationChunkSize, uncached.size());
+            for (auto i = begin; i < end; i++) {
+                exists[i] = depot->ResourceExists(uncached[i]);
+            }
+        };
+
+        ParallelJobs::Run((uncached.size() + g_validationChunkSize - 1) / g_validationChunkSize, validateChunk);
+
+        std::unique_lock lock(m_mutex);
+        // a concurrent validation against another archive set already replaced the results, these are stale
+        if (archiveFingerprint == m_archiveFingerprint) {
+            for (size_t i = 0; i < uncached.size(); i++) {
+                m_results.insert_or_assign(uncached[i], exists[i] != 0);
+            }
+        }
+
+        return uncached.size();
+    }
+
+    bool ResourceValidationCache::Exists(const uint64_t resourcePath) const {
+        std::shared_lock lock(m_mutex);
+
+        const auto it = m_results.find(resourcePath);
+        return it == m_results.end() || it->second;
+    }
+
+    size_t ResourceValidationCache::Size() const {
+        std::shared_lock lock(m_mutex);
+        return m_results.size();
+    }
+
+    size_t ResourceValidationCache::MemoryUsage() const {
+        std::shared_lock lock(m_mutex);
+        return m_results.size() * HashNodeBytes<uint64_t, bool>() + m_results.bucket_count() * sizeof(void*);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "RED4ext/ResourceDepot.hpp"
+
+namespace InfiniteRandomizerFramework {
+    // remembers which resource paths the depot holds, results stay valid until the loaded archives change
+    class ResourceValidationCache {
+    public:
+        // identifies the archives the depot currently serves by their paths, sizes and write times
+        static uint64_t ArchiveFingerprint(const RED4ext::ResourceDepot* depot);
+
+        // queries the depot for every path without a result for the current archive set, returns how many were queried
+        size_t Validate(RED4ext::ResourceDepot* depot, const std::vector<uint64_t>& resourcePaths);
+        // paths that were never validated are reported as existing
+        [[nodiscard]] bool Exists(uint64_t resourcePath) const;
+
+        [[nodiscard]] size_t Size() const;
+        [[nodiscard]] size_t MemoryUsage() const;
+
+    private:
+        mutable std::shared_mutex m_mutex;
+        uint64_t m_archiveFingerprint = 0;
+        std::unordered_map<uint64_t, bool> m_results;
+    };
+}
@@ -0,0 +1,162 @@
+#include "SectorManifest.h"
+
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+
+#include "CacheFile.h"
+
+namespace InfiniteRandomizerFramework {
+    namespace {
+        constexpr uint32_t g_manifestMagic = 0x4d465249; // IRFM
+        constexpr uint32_t g_manifestVersion = 3;
+        // comfortably above the sectors of the base game and its expansion
+        constexpr uint32_t g_manifestCapacity = 1 << 17;
+        // sessions an entry survives without being looked up or stored
+        constexpr uint32_t g_manifestMaxIdleSessions = 16;
+    }
+
+    bool SectorManifest::TryGet(const uint64_t sectorPathHash, const uint64_t keySetHash, const uint64_t archiveFingerprint,
+                                const uint32_t nodeCount, std::vector<uint32_t>& nodeIndices) const {
+        std::shared_lock lock(m_mutex);
+
+        const auto it = m_entries.find(sectorPathHash);
+        if (it == m_entries.end() || it->second.keySetHash != keySetHash || it->second.archiveFingerprint != archiveFingerprint
+            || it->second.nodeCount != nodeCount) {
+            return false;
+        }
+
+        // concurrent lookups of one sector all write the same session
+        std::atomic_ref lastSession(it->second.lastSession);
+        if (lastSession.load(std::memory_order_relaxed) != m_session) {
+            lastSession.store(m_session, std::memory_order_relaxed);
+            m_dirty = true;
+        }
+
+        nodeIndices = it->second.nodeIndices;
+        return true;
+    }
+
+    void SectorManifest::Store(const uint64_t sectorPathHash, const uint64_t keySetHash, const uint64_t archiveFingerprint,
+                               const uint32_t nodeCount, std::vector<uint32_t> nodeIndices) {
+        std::unique_lock lock(m_mutex);
+
+        m_entries.insert_or_assign(sectorPathHash, Entry{keySetHash, archiveFingerprint, nodeCount, m_session, std::move(nodeIndices)});
+        m_dirty = true;
+    }
+
+    bool SectorManifest::Load(const std::filesystem::path& path) {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream) {
+            return false;
+        }
+
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint32_t session = 0;
+        uint32_t count = 0;
+        // a saved manifest never holds more than the capacity
+        if (!CacheFile::Read(stream, magic) || !CacheFile::Read(stream, version) || !CacheFile::Read(stream, session)
+            || magic != g_manifestMagic || version != g_manifestVersion || !CacheFile::ReadLength(stream, count, g_manifestCapacity)) {
+            return false;
+        }
+        session++;
+
+        std::unordered_map<uint64_t, Entry> entries;
+        entries.reserve(count);
+        for (uint64_t i = 0; i < count; i++) {
+            uint64_t sectorPathHash = 0;
+            uint32_t indexCount = 0;
+            Entry entry{};
+            if (!CacheFile::Read(stream, sectorPathHash) || !CacheFile::Read(stream, entry.keySetHash) || !CacheFile::Read(stream, entry.archiveFingerprint)
+                || !CacheFile::Read(stream, entry.nodeCount) || !CacheFile::Read(stream, entry.lastSession)
+                || !CacheFile::ReadLength(stream, indexCount, std::min(entry.nodeCount, CacheFile::MaxLength))) {
+                return false;
+            }
+
+            entry.nodeIndices.resize(indexCount);
+            if (indexCount > 0 && !stream.read(reinterpret_cast<char*>(entry.nodeIndices.data()), indexCount * sizeof(uint32_t))) {
+                return false;
+            }
+            if (session - entry.lastSession <= g_manifestMaxIdleSessions) {
+                entries.insert_or_assign(sectorPathHash, std::move(entry));
+            }
+        }
+
+        std::unique_lock lock(m_mutex);
+        m_entries = std::move(entries);
+        m_session = session;
+        // the new session number has to reach the file even if nothing else changes
+        m_dirty = true;
+        return true;
+    }
+
+    bool SectorManifest::Save(const std::filesystem::path& path) {
+        std::unique_lock lock(m_mutex);
+        if (!m_dirty) {
+            return true;
+        }
+
+        EvictLeastRecentlyUsed();
+
+        const auto saved = CacheFile::Save(path, [this](std::ostream& stream) {
+            CacheFile::Write(stream, g_manifestMagic);
+            CacheFile::Write(stream, g_manifestVersion);
+            CacheFile::Write(stream, m_session);
+            CacheFile::Write(stream, static_cast<uint32_t>(m_entries.size()));
+            for (const auto& [sectorPathHash, entry] : m_entries) {
+                CacheFile::Write(stream, sectorPathHash);
+                CacheFile::Write(stream, entry.keySetHash);
+                CacheFile::Write(stream, entry.archiveFingerprint);
+                CacheFile::Write(stream, entry.nodeCount);
+                CacheFile::Write(stream, entry.lastSession);
+                CacheFile::Write(stream, static_cast<uint32_t>(entry.nodeIndices.size()));
+                stream.write(reinterpret_cast<const char*>(entry.nodeIndices.data()), entry.nodeIndices.size() * sizeof(uint32_t));
+            }
+        });
+        if (!saved) {
+            return false;
+        }
+
+        m_dirty = false;
+        return true;
+    }
+
+    void SectorManifest::EvictLeastRecentlyUsed() {
+        if (m_entries.size() <= g_manifestCapacity) {
+            return;
+        }
+
+        std::vector<uint32_t> sessions;
+        sessions.reserve(m_entries.size());
+        for (const auto& entry : m_entries) {
+            sessions.push_back(entry.second.lastSession);
+        }
+
+        // entries used before the session at the cut are dropped, then entries of that session until the capacity is met
+        const auto cut = sessions.begin() + static_cast<std::ptrdiff_t>(sessions.size() - g_manifestCapacity);
+        std::ranges::nth_element(sessions, cut);
+        const auto oldestKept = *cut;
+        std::erase_if(m_entries, [oldestKept](const auto& entry) {
+            return entry.second.lastSession < oldestKept;
+        });
+        for (auto it = m_entries.begin(); it != m_entries.end() && m_entries.size() > g_manifestCapacity;) {
+            it = it->second.lastSession == oldestKept ? m_entries.erase(it) : std::next(it);
+        }
+    }
+
+    size_t SectorManifest::Size() const {
+        std::shared_lock lock(m_mutex);
+        return m_entries.size();
+    }
+
+    size_t SectorManifest::MemoryUsage() const {
+        std::shared_lock lock(m_mutex);
+
+        size_t bytes = m_entries.bucket_count() * 2 * sizeof(void*);
+        for (const auto& entry : m_entries) {
+            bytes += sizeof(entry) + 2 * sizeof(void*) + entry.second.nodeIndices.capacity() * sizeof(uint32_t);
+        }
+        return bytes;
+    }
+}
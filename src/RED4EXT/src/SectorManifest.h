@@ -0,0 +1,48 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace InfiniteRandomizerFramework {
+    // remembers per sector which node indices held replaceable resources for a given set of replaceable paths
+    // and loaded archives, a mod replacing a sector changes the archives even if the node count stays the same.
+    // an empty index list is a negative entry, the sector can be skipped without looking at its nodes.
+    // entries unused for a number of sessions are dropped when loading and the least recently used ones when saving
+    // beyond the capacity, so the file does not grow with every sector ever visited
+    class SectorManifest {
+    public:
+        // copies the recorded indices, returns false if the sector was not recorded for this key set, archive set and node count
+        bool TryGet(uint64_t sectorPathHash, uint64_t keySetHash, uint64_t archiveFingerprint, uint32_t nodeCount,
+                    std::vector<uint32_t>& nodeIndices) const;
+        void Store(uint64_t sectorPathHash, uint64_t keySetHash, uint64_t archiveFingerprint, uint32_t nodeCount,
+                   std::vector<uint32_t> nodeIndices);
+
+        bool Load(const std::filesystem::path& path);
+        bool Save(const std::filesystem::path& path);
+
+        [[nodiscard]] size_t Size() const;
+        [[nodiscard]] size_t MemoryUsage() const;
+
+    private:
+        // expects the unique lock
+        void EvictLeastRecentlyUsed();
+
+        struct Entry {
+            uint64_t keySetHash;
+            uint64_t archiveFingerprint;
+            uint32_t nodeCount;
+            // updated by lookups under the shared lock through std::atomic_ref
+            mutable uint32_t lastSession;
+            std::vector<uint32_t> nodeIndices;
+        };
+
+        mutable std::shared_mutex m_mutex;
+        std::unordered_map<uint64_t, Entry> m_entries;
+        // counts the game sessions the manifest was loaded in
+        uint32_t m_session = 0;
+        mutable std::atomic<bool> m_dirty = false;
+    };
+}
@@ -0,0 +1,153 @@
+#include "VarietyBudget.h"
+
+#include <algorithm>
+#include <ranges>
+
+#include "DataStructs/MemoryReport.h"
+
+namespace InfiniteRandomizerFramework {
+    void VarietyBudget::Reset(const uint32_t limit) {
+        std::lock_guard lock(m_mutex);
+
+        m_limit = limit;
+        m_live.clear();
+        m_sectors.clear();
+    }
+
+    uint32_t VarietyBudget::Limit() const {
+        std::lock_guard lock(m_mutex);
+        return m_limit;
+    }
+
+    bool VarietyBudget::Allows(const uint32_t categoryId, const uint64_t resourcePath) const {
+        std::lock_guard lock(m_mutex);
+
+        const auto it = m_live.find(categoryId);
+        return it == m_live.end() || it->second.size() < m_limit || it->second.contains(resourcePath);
+    }
+
+    VarietyBudget::Admissions VarietyBudget::Snapshot(const std::vector<uint32_t>& categoryIds) const {
+        Admissions admissions;
+        std::lock_guard lock(m_mutex);
+
+        for (const auto categoryId : categoryIds) {
+            const auto it = m_live.find(categoryId);
+            if (it == m_live.end() || it->second.size() < m_limit) {
+                continue;
+            }
+
+            auto& [fullId, variants] = admissions.m_full.emplace_back(categoryId, std::vector<uint64_t>());
+            variants.reserve(it->second.size());
+            for (const auto resourcePath : it->second | std::views::keys) {
+                variants.push_back(resourcePath);
+            }
+            std::ranges::sort(variants);
+        }
+        return admissions;
+    }
+
+    bool VarietyBudget::Admissions::Allows(const uint32_t categoryId, const uint64_t resourcePath) const {
+        const auto it = std::ranges::find(m_full, categoryId, &std::pair<uint32_t, std::vector<uint64_t>>::first);
+        return it == m_full.end() || std::ranges::binary_search(it->second, resourcePath);
+    }
+
+    bool VarietyBudget::Acquire(const uint32_t categoryId, const uint64_t resourcePath, std::vector<LiveVariant>& sectorVariants) {
+        // a sector holds one reference per distinct variant, however many of its nodes use it
+        const auto held = std::ranges::any_of(sectorVariants, [categoryId, resourcePath](const LiveVariant& variant) {
+            return variant.categoryId == categoryId && variant.resourcePath == resourcePath;
+        });
+        if (held) {
+            return true;
+        }
+
+        std::lock_guard lock(m_mutex);
+
+        auto& variants = m_live[categoryId];
+        const auto it = variants.find(resourcePath);
+        if (it != variants.end()) {
+            it->second++;
+        } else if (variants.size() < m_limit) {
+            variants.emplace(resourcePath, 1);
+        } else {
+            return false;
+        }
+
+        sectorVariants.push_back({categoryId, resourcePath});
+        return true;
+    }
+
+    void VarietyBudget::Track(const RED4ext::WeakHandle<RED4ext::ISerializable>& sector, std::vector<LiveVariant> sectorVariants) {
+        if (sectorVariants.empty()) {
+            return;
+        }
+
+        std::lock_guard lock(m_mutex);
+
+        auto& tracked = m_sectors[sector.instance];
+        ReleaseVariants(tracked.variants);
+        tracked = {sector, std::move(sectorVariants)};
+    }
+
+    void VarietyBudget::Release(const RED4ext::ISerializable* sector) {
+        std::lock_guard lock(m_mutex);
+
+        if (const auto it = m_sectors.find(sector); it != m_sectors.end()) {
+            ReleaseVariants(it->second.variants);
+            m_sectors.erase(it);
+        }
+    }
+
+    void VarietyBudget::ReleaseExpired() {
+        std::lock_guard lock(m_mutex);
+
+        for (auto it = m_sectors.begin(); it != m_sectors.end();) {
+            if (!it->second.sector.Expired()) {
+                ++it;
+                continue;
+            }
+
+            ReleaseVariants(it->second.variants);
+            it = m_sectors.erase(it);
+        }
+    }
+
+    void VarietyBudget::ReleaseVariants(const std::vector<LiveVariant>& variants) {
+        for (const auto& variant : variants) {
+            const auto categoryIt = m_live.find(variant.categoryId);
+            if (categoryIt == m_live.end()) {
+                continue;
+            }
+
+            const auto variantIt = categoryIt->second.find(variant.resourcePath);
+            if (variantIt != categoryIt->second.end() && --variantIt->second == 0) {
+                categoryIt->second.erase(variantIt);
+            }
+        }
+    }
+
+    size_t VarietyBudget::LiveCount() const {
+        std::lock_guard lock(m_mutex);
+
+        size_t count = 0;
+        for (const auto& variants : m_live) {
+            count += variants.second.size();
+        }
+        return count;
+    }
+
+    size_t VarietyBudget::MemoryUsage() const {
+        std::lock_guard lock(m_mutex);
+
+        size_t bytes = m_sectors.size() * HashNodeBytes<const RED4ext::ISerializable*, TrackedSector>()
+            + m_sectors.bucket_count() * sizeof(void*);
+        for (const auto& tracked : m_sectors | std::views::values) {
+            bytes += tracked.variants.capacity() * sizeof(LiveVariant);
+        }
+        for (const auto& variants : m_live) {
+            bytes += HashNodeBytes<uint32_t, std::unordered_map<uint64_t, uint32_t>>()
+                + variants.second.size() * HashNodeBytes<uint64_t, uint32_t>()
+                + variants.second.bucket_count() * sizeof(void*);
+        }
+        return bytes;
+    }
+}
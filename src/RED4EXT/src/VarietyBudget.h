@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "RED4ext/ISerializable.hpp"
+
+namespace InfiniteRandomizerFramework {
+    // caps how many distinct variants of a category are live at once, a variant is live while a loaded sector uses it.
+    // sectors are released when the engine destroys them, or by the next sweep after their weak handle expired
+    class VarietyBudget {
+    public:
+        struct LiveVariant {
+            uint32_t categoryId;
+            uint64_t resourcePath;
+        };
+
+        // drops every live variant, a limit of 0 disables the budget
+        void Reset(uint32_t limit);
+        [[nodiscard]] uint32_t Limit() const;
+
+        // what a set of categories admits at one moment, asked without taking the lock again
+        class Admissions {
+        public:
+            [[nodiscard]] bool Allows(uint32_t categoryId, uint64_t resourcePath) const;
+
+        private:
+            friend class VarietyBudget;
+            // full categories with their sorted live variants, any other category admits anything
+            std::vector<std::pair<uint32_t, std::vector<uint64_t>>> m_full;
+        };
+
+        // a category below its limit admits anything, a full one only its live variants
+        [[nodiscard]] bool Allows(uint32_t categoryId, uint64_t resourcePath) const;
+        // takes the lock once for all given categories, for weighing many entries in one draw
+        [[nodiscard]] Admissions Snapshot(const std::vector<uint32_t>& categoryIds) const;
+        // false when another sector filled the category since Allows was asked, the variant is not acquired then
+        [[nodiscard]] bool Acquire(uint32_t categoryId, uint64_t resourcePath, std::vector<LiveVariant>& sectorVariants);
+
+        // hands the variants a sector acquired to its lifetime
+        void Track(const RED4ext::WeakHandle<RED4ext::ISerializable>& sector, std::vector<LiveVariant> sectorVariants);
+        // releases the variants of a sector the engine is destroying
+        void Release(const RED4ext::ISerializable* sector);
+        // releases the variants of sectors whose weak handle expired, for when destruction is not observed
+        void ReleaseExpired();
+
+        [[nodiscard]] size_t LiveCount() const;
+        [[nodiscard]] size_t MemoryUsage() const;
+
+    private:
+        struct TrackedSector {
+            RED4ext::WeakHandle<RED4ext::ISerializable> sector;
+            std::vector<LiveVariant> variants;
+        };
+
+        void ReleaseVariants(const std::vector<LiveVariant>& variants);
+
+        mutable std::mutex m_mutex;
+        uint32_t m_limit = 0;
+        // category id -> live variant -> number of sectors using it
+        std::unordered_map<uint32_t, std::unordered_map<uint64_t, uint32_t>> m_live;
+        // keyed by instance, an address the engine reuses is released before it is tracked again
+        std::unordered_map<const RED4ext::ISerializable*, TrackedSector> m_sectors;
+    };
+}